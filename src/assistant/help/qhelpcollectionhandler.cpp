@@ -23,6 +23,9 @@
 
 QT_BEGIN_NAMESPACE
 
+// Stored as the user_version of the collection file. Version 1 adds the indexes.
+static const int CollectionSchemaVersion = 1;
+
 class Transaction
 {
 public:
@@ -82,12 +85,31 @@ void QHelpCollectionHandler::closeDB()
     if (!m_query)
         return;
 
+    qDeleteAll(m_preparedQueries);
+    m_preparedQueries.clear();
     delete m_query;
     m_query = nullptr;
     QSqlDatabase::removeDatabase(m_connectionName);
     m_connectionName = QString();
 }
 
+/*
+    Returns a query for \a statement. Queries are prepared only once per
+    statement, so that frequent lookups do not have SQLite parse and plan
+    the same statement again. Callers must finish() the query when done,
+    so that it does not keep the database locked.
+*/
+QSqlQuery *QHelpCollectionHandler::preparedQuery(const QString &statement) const
+{
+    QSqlQuery *&query = m_preparedQueries[statement];
+    if (!query) {
+        query = new QSqlQuery(QSqlDatabase::database(m_connectionName));
+        query->setForwardOnly(true);
+        query->prepare(statement);
+    }
+    return query;
+}
+
 QString QHelpCollectionHandler::collectionFile() const
 {
     return m_collectionFile;
@@ -176,6 +198,16 @@ bool QHelpCollectionHandler::openCollectionFile()
 
         // Old tables exist, index tables didn't, recreate index tables only in this case
         indexAndNamespaceFilterTablesMissing = tablesExist;
+    } else {
+        m_query->exec(QLatin1String("PRAGMA user_version"));
+        const int schemaVersion = m_query->next() ? m_query->value(0).toInt() : 0;
+        // The indexes only speed up the lookups, so a collection that cannot
+        // be migrated (for example on read-only storage) is still usable.
+        if (schemaVersion < CollectionSchemaVersion && !createIndexes(m_query)) {
+            qWarning("Cannot create indexes in file %s: %s",
+                     qUtf8Printable(collectionFile()),
+                     qUtf8Printable(m_query->lastError().text()));
+        }
     }
 
     const FileInfoList &docList = registeredDocumentations();
@@ -519,6 +551,61 @@ bool QHelpCollectionHandler::recreateIndexAndNamespaceFilterTables(QSqlQuery *qu
         if (!query->exec(q))
             return false;
     }
+    return createIndexes(query);
+}
+
+/*
+    Creates the indexes the lookups need and updates the schema version.
+    The indexes on IndexTable cover the keyword and identifier lookups,
+    and the one on LOWER(Name) provides the order of the index view.
+*/
+bool QHelpCollectionHandler::createIndexes(QSqlQuery *query)
+{
+    const QStringList indexes = QStringList()
+            << QLatin1String("CREATE INDEX IF NOT EXISTS NamespaceTableNameIndex "
+                             "ON NamespaceTable (Name)")
+            << QLatin1String("CREATE INDEX IF NOT EXISTS FolderTableNamespaceIdIndex "
+                             "ON FolderTable (NamespaceId, Name)")
+            << QLatin1String("CREATE INDEX IF NOT EXISTS FolderTableNameIndex "
+                             "ON FolderTable (Name)")
+            << QLatin1String("CREATE INDEX IF NOT EXISTS FilterAttributeTableNameIndex "
+                             "ON FilterAttributeTable (Name)")
+            << QLatin1String("CREATE INDEX IF NOT EXISTS FileNameTableFolderIdIndex "
+                             "ON FileNameTable (FolderId, Name)")
+            << QLatin1String("CREATE INDEX IF NOT EXISTS FileNameTableNameIndex "
+                             "ON FileNameTable (Name)")
+            << QLatin1String("CREATE INDEX IF NOT EXISTS IndexTableNameIndex "
+                             "ON IndexTable (Name, NamespaceId, FileId, Anchor)")
+            << QLatin1String("CREATE INDEX IF NOT EXISTS IndexTableIdentifierIndex "
+                             "ON IndexTable (Identifier, NamespaceId, FileId, Anchor)")
+            << QLatin1String("CREATE INDEX IF NOT EXISTS IndexTableLowerNameIndex "
+                             "ON IndexTable (LOWER(Name), Name)")
+            << QLatin1String("CREATE INDEX IF NOT EXISTS IndexTableNamespaceIdIndex "
+                             "ON IndexTable (NamespaceId)")
+            << QLatin1String("CREATE INDEX IF NOT EXISTS IndexTableFileIdIndex "
+                             "ON IndexTable (FileId)")
+            << QLatin1String("CREATE INDEX IF NOT EXISTS ContentsTableNamespaceIdIndex "
+                             "ON ContentsTable (NamespaceId)")
+            << QLatin1String("CREATE INDEX IF NOT EXISTS FileFilterTableIndex "
+                             "ON FileFilterTable (FilterAttributeId, FileId)")
+            << QLatin1String("CREATE INDEX IF NOT EXISTS IndexFilterTableIndex "
+                             "ON IndexFilterTable (FilterAttributeId, IndexId)")
+            << QLatin1String("CREATE INDEX IF NOT EXISTS ContentsFilterTableIndex "
+                             "ON ContentsFilterTable (FilterAttributeId, ContentsId)")
+            << QLatin1String("CREATE INDEX IF NOT EXISTS OptimizedFilterTableIndex "
+                             "ON OptimizedFilterTable (FilterAttributeId, NamespaceId)")
+            << QLatin1String("CREATE INDEX IF NOT EXISTS VersionTableNamespaceIdIndex "
+                             "ON VersionTable (NamespaceId)")
+            << QLatin1String("CREATE INDEX IF NOT EXISTS ComponentMappingNamespaceIdIndex "
+                             "ON ComponentMapping (NamespaceId)")
+            << QLatin1String("CREATE INDEX IF NOT EXISTS FilterNameIndex "
+                             "ON Filter (Name)")
+            << QString::fromLatin1("PRAGMA user_version=%1").arg(CollectionSchemaVersion);
+
+    for (const QString &q : indexes) {
+        if (!query->exec(q))
+            return false;
+    }
     return true;
 }
 
@@ -1137,17 +1224,18 @@ QString QHelpCollectionHandler::namespaceForFile(const QUrl &url,
                                  QLatin1String("FileFilterTable"),
                                  QLatin1String("FileId"));
 
-    m_query->prepare(filterQuery);
-    m_query->bindValue(0, fileInfo.folderName);
-    m_query->bindValue(1, fileInfo.fileName);
-    bindFilterQuery(m_query, 2, filterAttributes);
+    QSqlQuery *query = preparedQuery(filterQuery);
+    query->bindValue(0, fileInfo.folderName);
+    query->bindValue(1, fileInfo.fileName);
+    bindFilterQuery(query, 2, filterAttributes);
 
-    if (!m_query->exec())
+    if (!query->exec())
         return QString();
 
     QList<QString> namespaceList;
-    while (m_query->next())
-        namespaceList.append(m_query->value(0).toString());
+    while (query->next())
+        namespaceList.append(query->value(0).toString());
+    query->finish();
 
     if (namespaceList.isEmpty())
         return QString();
@@ -1192,17 +1280,18 @@ QString QHelpCollectionHandler::namespaceForFile(const QUrl &url,
     const QString filterQuery = filterlessQuery
             + prepareFilterQuery(filterName);
 
-    m_query->prepare(filterQuery);
-    m_query->bindValue(0, fileInfo.folderName);
-    m_query->bindValue(1, fileInfo.fileName);
-    bindFilterQuery(m_query, 2, filterName);
+    QSqlQuery *query = preparedQuery(filterQuery);
+    query->bindValue(0, fileInfo.folderName);
+    query->bindValue(1, fileInfo.fileName);
+    bindFilterQuery(query, 2, filterName);
 
-    if (!m_query->exec())
+    if (!query->exec())
         return QString();
 
     QList<QString> namespaceList;
-    while (m_query->next())
-        namespaceList.append(m_query->value(0).toString());
+    while (query->next())
+        namespaceList.append(query->value(0).toString());
+    query->finish();
 
     if (namespaceList.isEmpty())
         return QString();
@@ -1250,24 +1339,25 @@ QStringList QHelpCollectionHandler::files(const QString &namespaceName,
                                  QLatin1String("FileFilterTable"),
                                  QLatin1String("FileId"));
 
-    m_query->prepare(filterQuery);
-    m_query->bindValue(0, namespaceName);
+    QSqlQuery *query = preparedQuery(filterQuery);
+    query->bindValue(0, namespaceName);
     int bindCount = 1;
     if (!extensionFilter.isEmpty()) {
-        m_query->bindValue(bindCount, QString::fromLatin1("%.%1").arg(extensionFilter));
+        query->bindValue(bindCount, QString::fromLatin1("%.%1").arg(extensionFilter));
         ++bindCount;
     }
-    bindFilterQuery(m_query, bindCount, filterAttributes);
+    bindFilterQuery(query, bindCount, filterAttributes);
 
-    if (!m_query->exec())
+    if (!query->exec())
         return QStringList();
 
     QStringList fileNames;
-    while (m_query->next()) {
-        fileNames.append(m_query->value(0).toString()
+    while (query->next()) {
+        fileNames.append(query->value(0).toString()
                          + QLatin1Char('/')
-                         + m_query->value(1).toString());
+                         + query->value(1).toString());
     }
+    query->finish();
 
     return fileNames;
 }
@@ -1296,25 +1386,26 @@ QStringList QHelpCollectionHandler::files(const QString &namespaceName,
     const QString filterQuery = filterlessQuery
             + prepareFilterQuery(filterName);
 
-    m_query->prepare(filterQuery);
-    m_query->bindValue(0, namespaceName);
+    QSqlQuery *query = preparedQuery(filterQuery);
+    query->bindValue(0, namespaceName);
     int bindCount = 1;
     if (!extensionFilter.isEmpty()) {
-        m_query->bindValue(bindCount, QString::fromLatin1("%.%1").arg(extensionFilter));
+        query->bindValue(bindCount, QString::fromLatin1("%.%1").arg(extensionFilter));
         ++bindCount;
     }
 
-    bindFilterQuery(m_query, bindCount, filterName);
+    bindFilterQuery(query, bindCount, filterName);
 
-    if (!m_query->exec())
+    if (!query->exec())
         return QStringList();
 
     QStringList fileNames;
-    while (m_query->next()) {
-        fileNames.append(m_query->value(0).toString()
+    while (query->next()) {
+        fileNames.append(query->value(0).toString()
                          + QLatin1Char('/')
-                         + m_query->value(1).toString());
+                         + query->value(1).toString());
     }
+    query->finish();
 
     return fileNames;
 }
@@ -1397,13 +1488,14 @@ QStringList QHelpCollectionHandler::indicesForFilter(const QStringList &filterAt
             + QLatin1String(" ORDER BY LOWER(IndexTable.Name), IndexTable.Name");
     //  this doesn't work: ASC COLLATE NOCASE
 
-    m_query->prepare(filterQuery);
-    bindFilterQuery(m_query, 0, filterAttributes);
+    QSqlQuery *query = preparedQuery(filterQuery);
+    bindFilterQuery(query, 0, filterAttributes);
 
-    m_query->exec();
+    query->exec();
 
-    while (m_query->next())
-        indices.append(m_query->value(0).toString());
+    while (query->next())
+        indices.append(query->value(0).toString());
+    query->finish();
 
     return indices;
 }
@@ -1432,13 +1524,14 @@ QStringList QHelpCollectionHandler::indicesForFilter(const QString &filterName)
             + prepareFilterQuery(filterName)
             + QLatin1String(" ORDER BY LOWER(IndexTable.Name), IndexTable.Name");
 
-    m_query->prepare(filterQuery);
-    bindFilterQuery(m_query, 0, filterName);
+    QSqlQuery *query = preparedQuery(filterQuery);
+    bindFilterQuery(query, 0, filterName);
 
-    m_query->exec();
+    query->exec();
 
-    while (m_query->next())
-        indices.append(m_query->value(0).toString());
+    while (query->next())
+        indices.append(query->value(0).toString());
+    query->finish();
 
     return indices;
 }
@@ -1489,26 +1582,27 @@ QList<QHelpCollectionHandler::ContentsData> QHelpCollectionHandler::contentsForF
                                  QLatin1String("ContentsFilterTable"),
                                  QLatin1String("ContentsId"));
 
-    m_query->prepare(filterQuery);
-    bindFilterQuery(m_query, 0, filterAttributes);
+    QSqlQuery *query = preparedQuery(filterQuery);
+    bindFilterQuery(query, 0, filterAttributes);
 
-    m_query->exec();
+    query->exec();
 
     QMap<QString, QMap<QVersionNumber, ContentsData>> contentsMap;
 
-    while (m_query->next()) {
-        const QString namespaceName = m_query->value(0).toString();
-        const QByteArray contents = m_query->value(2).toByteArray();
-        const QString versionString = m_query->value(3).toString();
+    while (query->next()) {
+        const QString namespaceName = query->value(0).toString();
+        const QByteArray contents = query->value(2).toByteArray();
+        const QString versionString = query->value(3).toString();
 
         const QString title = getTitle(contents);
         const QVersionNumber version = QVersionNumber::fromString(versionString);
         // get existing or insert a new one otherwise
         ContentsData &contentsData = contentsMap[title][version];
         contentsData.namespaceName = namespaceName;
-        contentsData.folderName = m_query->value(1).toString();
+        contentsData.folderName = query->value(1).toString();
         contentsData.contentsList.append(contents);
     }
+    query->finish();
 
     QList<QHelpCollectionHandler::ContentsData> result;
     for (const auto &versionContents : qAsConst(contentsMap)) {
@@ -1548,26 +1642,27 @@ QList<QHelpCollectionHandler::ContentsData> QHelpCollectionHandler::contentsForF
     const QString filterQuery = filterlessQuery
             + prepareFilterQuery(filterName);
 
-    m_query->prepare(filterQuery);
-    bindFilterQuery(m_query, 0, filterName);
+    QSqlQuery *query = preparedQuery(filterQuery);
+    bindFilterQuery(query, 0, filterName);
 
-    m_query->exec();
+    query->exec();
 
     QMap<QString, QMap<QVersionNumber, ContentsData>> contentsMap;
 
-    while (m_query->next()) {
-        const QString namespaceName = m_query->value(0).toString();
-        const QByteArray contents = m_query->value(2).toByteArray();
-        const QString versionString = m_query->value(3).toString();
+    while (query->next()) {
+        const QString namespaceName = query->value(0).toString();
+        const QByteArray contents = query->value(2).toByteArray();
+        const QString versionString = query->value(3).toString();
 
         const QString title = getTitle(contents);
         const QVersionNumber version = QVersionNumber::fromString(versionString);
         // get existing or insert a new one otherwise
         ContentsData &contentsData = contentsMap[title][version];
         contentsData.namespaceName = namespaceName;
-        contentsData.folderName = m_query->value(1).toString();
+        contentsData.folderName = query->value(1).toString();
         contentsData.contentsList.append(contents);
     }
+    query->finish();
 
     QList<QHelpCollectionHandler::ContentsData> result;
     for (const auto &versionContents : qAsConst(contentsMap)) {
@@ -2349,23 +2444,24 @@ QList<QHelpLink> QHelpCollectionHandler::documentsForField(
                                  QLatin1String("IndexFilterTable"),
                                  QLatin1String("IndexId"));
 
-    m_query->prepare(filterQuery);
-    m_query->bindValue(0, fieldValue);
-    bindFilterQuery(m_query, 1, filterAttributes);
+    QSqlQuery *query = preparedQuery(filterQuery);
+    query->bindValue(0, fieldValue);
+    bindFilterQuery(query, 1, filterAttributes);
 
-    m_query->exec();
+    query->exec();
 
-    while (m_query->next()) {
-        QString title = m_query->value(0).toString();
+    while (query->next()) {
+        QString title = query->value(0).toString();
         if (title.isEmpty()) // generate a title + corresponding path
-            title = fieldValue + QLatin1String(" : ") + m_query->value(3).toString();
+            title = fieldValue + QLatin1String(" : ") + query->value(3).toString();
 
-        const QUrl url = buildQUrl(m_query->value(1).toString(),
-                                   m_query->value(2).toString(),
-                                   m_query->value(3).toString(),
-                                   m_query->value(4).toString());
+        const QUrl url = buildQUrl(query->value(1).toString(),
+                                   query->value(2).toString(),
+                                   query->value(3).toString(),
+                                   query->value(4).toString());
         docList.append(QHelpLink {url, title});
     }
+    query->finish();
     return docList;
 }
 
@@ -2441,23 +2537,24 @@ QList<QHelpLink> QHelpCollectionHandler::documentsForField(
             + prepareFilterQuery(filterName)
             + QLatin1String(" ORDER BY LOWER(FileNameTable.Title), FileNameTable.Title");
 
-    m_query->prepare(filterQuery);
-    m_query->bindValue(0, fieldValue);
-    bindFilterQuery(m_query, 1, filterName);
+    QSqlQuery *query = preparedQuery(filterQuery);
+    query->bindValue(0, fieldValue);
+    bindFilterQuery(query, 1, filterName);
 
-    m_query->exec();
+    query->exec();
 
-    while (m_query->next()) {
-        QString title = m_query->value(0).toString();
+    while (query->next()) {
+        QString title = query->value(0).toString();
         if (title.isEmpty()) // generate a title + corresponding path
-            title = fieldValue + QLatin1String(" : ") + m_query->value(3).toString();
+            title = fieldValue + QLatin1String(" : ") + query->value(3).toString();
 
-        const QUrl url = buildQUrl(m_query->value(1).toString(),
-                                   m_query->value(2).toString(),
-                                   m_query->value(3).toString(),
-                                   m_query->value(4).toString());
+        const QUrl url = buildQUrl(query->value(1).toString(),
+                                   query->value(2).toString(),
+                                   query->value(3).toString(),
+                                   query->value(4).toString());
         docList.append(QHelpLink {url, title});
     }
+    query->finish();
     return docList;
 }
 
@@ -2478,13 +2575,14 @@ QStringList QHelpCollectionHandler::namespacesForFilter(const QString &filterNam
     const QString filterQuery = filterlessQuery
             + prepareFilterQuery(filterName);
 
-    m_query->prepare(filterQuery);
-    bindFilterQuery(m_query, 0, filterName);
+    QSqlQuery *query = preparedQuery(filterQuery);
+    bindFilterQuery(query, 0, filterName);
 
-    m_query->exec();
+    query->exec();
 
-    while (m_query->next())
-        namespaceList.append(m_query->value(0).toString());
+    while (query->next())
+        namespaceList.append(query->value(0).toString());
+    query->finish();
 
     return namespaceList;
 }
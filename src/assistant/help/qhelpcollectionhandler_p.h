@@ -15,6 +15,7 @@
 // We mean it.
 //
 
+#include <QtCore/QHash>
 #include <QtCore/QList>
 #include <QtCore/QString>
 #include <QtCore/QObject>
@@ -200,7 +201,9 @@ private:
                                        const QString &filterName) const;
 
     bool isDBOpened() const;
+    QSqlQuery *preparedQuery(const QString &statement) const;
     bool createTables(QSqlQuery *query);
+    bool createIndexes(QSqlQuery *query);
     void closeDB();
     bool recreateIndexAndNamespaceFilterTables(QSqlQuery *query);
     bool registerIndexAndNamespaceFilterTables(const QString &nameSpace,
@@ -220,6 +223,7 @@ private:
     QString m_collectionFile;
     QString m_connectionName;
     QSqlQuery *m_query = nullptr;
+    mutable QHash<QString, QSqlQuery *> m_preparedQueries; // by statement
     bool m_vacuumScheduled = false;
     bool m_readOnly = true;
 };
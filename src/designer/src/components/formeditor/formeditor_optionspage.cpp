@@ -22,6 +22,7 @@
 #include <QtWidgets/qboxlayout.h>
 #include <QtWidgets/qformlayout.h>
 #include <QtWidgets/qcombobox.h>
+#include <QtWidgets/qspinbox.h>
 
 QT_BEGIN_NAMESPACE
 
@@ -117,11 +118,30 @@ QWidget *FormEditorOptionsPage::createPage(QWidget *parent)
     m_namingComboBox->setCurrentIndex(settings.objectNamingMode());
     namingHLayout->addWidget(m_namingComboBox.data());
 
+    QGroupBox *undoGroupBox =
+        new QGroupBox(QCoreApplication::translate("FormEditorOptionsPage", "Undo History"));
+    const QString undoToolTip =
+        QCoreApplication::translate("FormEditorOptionsPage",
+                                    "Number of commands kept for undo in each form. "
+                                    "Takes effect for forms opened afterwards.");
+    undoGroupBox->setToolTip(undoToolTip);
+    QFormLayout *undoLayout = new QFormLayout(undoGroupBox);
+    m_undoLimitSpinBox = new QSpinBox;
+    m_undoLimitSpinBox->setToolTip(undoToolTip);
+    m_undoLimitSpinBox->setRange(0, 100000);
+    //: Undo limit of 0
+    m_undoLimitSpinBox->setSpecialValueText(QCoreApplication::translate("FormEditorOptionsPage",
+                                                                        "Unlimited"));
+    m_undoLimitSpinBox->setValue(settings.undoLimit());
+    undoLayout->addRow(QCoreApplication::translate("FormEditorOptionsPage", "Maximum steps"),
+                       m_undoLimitSpinBox.data());
+
     QVBoxLayout *optionsVLayout = new QVBoxLayout();
     optionsVLayout->addWidget(m_defaultGridConf);
     optionsVLayout->addWidget(m_previewConf);
     optionsVLayout->addWidget(m_zoomSettingsWidget);
     optionsVLayout->addWidget(namingGroupBox);
+    optionsVLayout->addWidget(undoGroupBox);
     optionsVLayout->addStretch(1);
 
     // Outer layout to give it horizontal stretch
@@ -164,6 +184,10 @@ void FormEditorOptionsPage::apply()
         settings.setObjectNamingMode(namingMode);
         ActionEditor::setObjectNamingMode(namingMode);
     }
+
+    // QUndoStack only accepts a limit while it is empty, so open forms keep theirs
+    if (m_undoLimitSpinBox)
+        settings.setUndoLimit(m_undoLimitSpinBox->value());
 }
 
 void FormEditorOptionsPage::finish()
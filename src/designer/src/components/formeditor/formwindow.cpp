@@ -68,6 +68,7 @@
 #include <QtGui/qundogroup.h>
 
 #include <QtCore/qdebug.h>
+#include <QtCore/qloggingcategory.h>
 #include <QtCore/qbuffer.h>
 #include <QtCore/qtimer.h>
 #include <QtCore/qlist.h>
@@ -102,6 +103,8 @@ private:
 enum { debugFormWindow = 0 };
 }
 
+Q_LOGGING_CATEGORY(lcDesignerUndo, "qt.designer.undo")
+
 namespace qdesigner_internal {
 
 // ------------------------ FormWindow::Selection
@@ -266,12 +269,172 @@ void FormWindow::Selection::show(QWidget *w)
         s->show();
 }
 
+// ------------------------ FormWindow::GeometryIndex
+// Keeps the geometry of the visible managed widgets for rubber band
+// selection, grouped by container, that is, by the closest managed ancestor.
+// The rectangles are in the coordinates of the container, so a widget that
+// moves only invalidates the entries of its own container. The managed
+// widgets and the unmanaged widgets between them and their containers are
+// watched for geometry changes.
+
+class FormWindow::GeometryIndex : public QObject
+{
+    Q_DISABLE_COPY_MOVE(GeometryIndex)
+public:
+    struct Entry {
+        QWidget *widget;
+        QRect rect;
+    };
+
+    explicit GeometryIndex(FormWindow *formWindow);
+
+    void addWidget(QWidget *w);
+    void removeWidget(QWidget *w);
+    void clear() { m_containers.clear(); }
+
+    // The widgets below the main container whose rectangle intersects
+    // rect, in tree order and with rectangles in main container coordinates
+    QList<Entry> intersecting(const QRect &rect);
+
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private:
+    struct Container {
+        QList<Entry> entries;
+        bool valid = false;
+    };
+
+    QWidget *containerOf(QWidget *w) const;
+    void invalidate(QWidget *container);
+    const QList<Entry> &entries(QWidget *container);
+    void collectEntries(QWidget *container, QWidget *parent, QList<Entry> *entries) const;
+    void collectIntersecting(QWidget *container, const QPoint &offset, const QRect &rect,
+                             QList<Entry> *result);
+
+    FormWindow *m_formWindow;
+    QHash<QWidget *, Container> m_containers;
+};
+
+FormWindow::GeometryIndex::GeometryIndex(FormWindow *formWindow) :
+    QObject(formWindow),
+    m_formWindow(formWindow)
+{
+}
+
+void FormWindow::GeometryIndex::addWidget(QWidget *w)
+{
+    invalidate(containerOf(w));
+    w->installEventFilter(this);
+    for (QWidget *p = w->parentWidget(); p && p != m_formWindow && !m_formWindow->isManaged(p);
+         p = p->parentWidget()) {
+        p->installEventFilter(this);
+    }
+    // Deleted widgets are not always unmanaged first
+    connect(w, &QObject::destroyed, this, &GeometryIndex::clear);
+}
+
+void FormWindow::GeometryIndex::removeWidget(QWidget *w)
+{
+    invalidate(containerOf(w));
+    m_containers.remove(w);
+    w->removeEventFilter(this);
+    disconnect(w, &QObject::destroyed, this, &GeometryIndex::clear);
+}
+
+QWidget *FormWindow::GeometryIndex::containerOf(QWidget *w) const
+{
+    for (QWidget *p = w->parentWidget(); p && p != m_formWindow; p = p->parentWidget()) {
+        if (m_formWindow->isManaged(p))
+            return p;
+    }
+    return nullptr;
+}
+
+void FormWindow::GeometryIndex::invalidate(QWidget *container)
+{
+    const auto it = m_containers.find(container);
+    if (it != m_containers.end())
+        it->valid = false;
+}
+
+bool FormWindow::GeometryIndex::eventFilter(QObject *watched, QEvent *event)
+{
+    switch (event->type()) {
+    case QEvent::Move:
+    case QEvent::Resize:
+    case QEvent::Show:
+    case QEvent::Hide:
+        invalidate(containerOf(static_cast<QWidget *>(watched)));
+        break;
+    case QEvent::ParentChange:
+        clear();
+        break;
+    default:
+        break;
+    }
+    return false;
+}
+
+// Walks the children of parent down to the next managed widgets. Hidden
+// widgets are left out together with their children.
+void FormWindow::GeometryIndex::collectEntries(QWidget *container, QWidget *parent,
+                                               QList<Entry> *entries) const
+{
+    for (QObject *o : parent->children()) {
+        if (!o->isWidgetType())
+            continue;
+        QWidget *w = static_cast<QWidget *>(o);
+        if (w->isHidden() || w->isWindow())
+            continue;
+        if (m_formWindow->isManaged(w))
+            entries->append({w, QRect(w->mapTo(container, QPoint(0, 0)), w->size())});
+        else
+            collectEntries(container, w, entries);
+    }
+}
+
+const QList<FormWindow::GeometryIndex::Entry> &FormWindow::GeometryIndex::entries(QWidget *container)
+{
+    Container &c = m_containers[container];
+    if (!c.valid) {
+        c.entries.clear();
+        collectEntries(container, container, &c.entries);
+        c.valid = true;
+    }
+    return c.entries;
+}
+
+void FormWindow::GeometryIndex::collectIntersecting(QWidget *container, const QPoint &offset,
+                                                    const QRect &rect, QList<Entry> *result)
+{
+    // A copy, the recursion may rehash m_containers
+    const QList<Entry> containerEntries = entries(container);
+    for (const Entry &entry : containerEntries) {
+        const QRect r = entry.rect.translated(offset);
+        // Children are clipped to their container, so the ones of a
+        // container the rectangle misses cannot be hit either.
+        if (!r.intersects(rect))
+            continue;
+        result->append({entry.widget, r});
+        collectIntersecting(entry.widget, r.topLeft(), rect, result);
+    }
+}
+
+QList<FormWindow::GeometryIndex::Entry> FormWindow::GeometryIndex::intersecting(const QRect &rect)
+{
+    QList<Entry> result;
+    if (QWidget *mainContainer = m_formWindow->mainContainer())
+        collectIntersecting(mainContainer, QPoint(0, 0), rect, &result);
+    return result;
+}
+
 // ------------------------ FormWindow
 FormWindow::FormWindow(FormEditor *core, QWidget *parent, Qt::WindowFlags flags) :
     FormWindowBase(core, parent, flags),
     m_mouseState(NoMouseState),
     m_core(core),
     m_selection(new Selection),
+    m_geometryIndex(new GeometryIndex(this)),
     m_widgetStack(new FormWindowWidgetStack(this)),
     m_contextMenuPosition(-1, -1)
 {
@@ -399,8 +562,13 @@ void FormWindow::init()
     m_mainContainer = nullptr;
     m_currentWidget = nullptr;
 
+    m_undoStack.setUndoLimit(QDesignerSharedSettings(core()).undoLimit());
     connect(&m_undoStack, &QUndoStack::indexChanged,
             this, &QDesignerFormWindowInterface::changed);
+    connect(&m_undoStack, &QUndoStack::indexChanged, this, [this] {
+        qCDebug(lcDesignerUndo) << "Undo stack of" << this << ':' << m_undoStack.count()
+            << "commands," << QDesignerFormWindowCommand::memoryUsage(&m_undoStack) << "bytes";
+    });
     connect(&m_undoStack, &QUndoStack::cleanChanged,
             this, &FormWindow::slotCleanChanged);
     connect(this, &QDesignerFormWindowInterface::changed,
@@ -921,15 +1089,21 @@ bool FormWindow::isMainContainer(const QWidget *w) const
     return w && (w == this || w == mainContainer());
 }
 
-void FormWindow::updateChildSelections(QWidget *w)
+void FormWindow::updateChildSelections(QWidget *w, QSet<QWidget *> *updated)
 {
     const QWidgetList l = w->findChildren<QWidget*>();
     if (!l.isEmpty()) {
         const QWidgetList::const_iterator lcend = l.constEnd();
         for (QWidgetList::const_iterator it = l.constBegin(); it != lcend; ++it) {
             QWidget *w = *it;
-            if (isManaged(w))
-                updateSelection(w);
+            if (!isManaged(w))
+                continue;
+            if (updated) {
+                if (updated->contains(w))
+                    continue;
+                updated->insert(w);
+            }
+            updateSelection(w);
         }
     }
 }
@@ -1328,15 +1502,11 @@ QWidgetList FormWindow::selectedWidgets() const
 void FormWindow::selectWidgets()
 {
     bool selectionChanged = false;
-    const QWidgetList l = mainContainer()->findChildren<QWidget*>();
-    const QRect selRect(mapToGlobal(m_currRect.topLeft()), m_currRect.size());
-    for (QWidget *w : l) {
-        if (w->isVisibleTo(this) && isManaged(w)) {
-            const QPoint p = w->mapToGlobal(QPoint(0,0));
-            const QRect r(p, w->size());
-            if (r.intersects(selRect) && !r.contains(selRect) && trySelectWidget(w, true))
-                selectionChanged = true;
-        }
+    const QRect selRect(mainContainer()->mapFrom(this, m_currRect.topLeft()), m_currRect.size());
+    const auto entries = m_geometryIndex->intersecting(selRect);
+    for (const GeometryIndex::Entry &entry : entries) {
+        if (!entry.rect.contains(selRect) && trySelectWidget(entry.widget, true))
+            selectionChanged = true;
     }
 
     if (selectionChanged)
@@ -1629,6 +1799,15 @@ void FormWindow::setFileName(const QString &fileName)
     emit fileNameChanged(fileName);
 }
 
+DomUI *FormWindow::saveUi() const
+{
+    if (!mainContainer())
+        return nullptr;
+
+    QDesignerResource resource(const_cast<FormWindow*>(this));
+    return resource.saveUi(mainContainer());
+}
+
 QString FormWindow::contents() const
 {
     QBuffer b;
@@ -1934,6 +2113,7 @@ void FormWindow::manageWidget(QWidget *w)
 
     m_insertedWidgets.insert(w);
     m_widgets.append(w);
+    m_geometryIndex->addWidget(w);
 
 #if QT_CONFIG(cursor)
     setCursorToAll(Qt::ArrowCursor, w);
@@ -1962,6 +2142,7 @@ void FormWindow::unmanageWidget(QWidget *w)
 
     m_insertedWidgets.remove(w);
     m_widgets.removeAt(m_widgets.indexOf(w));
+    m_geometryIndex->removeWidget(w);
 
     emit changed();
     emit widgetUnmanaged(w);
@@ -2140,10 +2321,12 @@ bool FormWindow::setContents(QIODevice *dev, QString *errorMessageIn /* = 0 */)
     m_selection->clearSelectionPool();
     m_insertedWidgets.clear();
     m_widgets.clear();
+    m_geometryIndex->clear();
     // The main container is cleared as otherwise
     // the names of the newly loaded objects will be unified.
     clearMainContainer();
     m_undoStack.clear();
+    m_undoStack.setUndoLimit(QDesignerSharedSettings(core()).undoLimit());
     emit changed();
 
     QWidget *w = r.loadUi(ui.data(), formContainer());
@@ -2620,12 +2803,17 @@ void FormWindow::checkSelectionNow()
 {
     m_checkSelectionTimer->stop();
 
+    // Selected children of selected layouts are updated only once
     const QWidgetList &sel = selectedWidgets();
+    QSet<QWidget *> updated;
     for (QWidget *widget : sel) {
-        updateSelection(widget);
+        if (!updated.contains(widget)) {
+            updated.insert(widget);
+            updateSelection(widget);
+        }
 
         if (LayoutInfo::layoutType(core(), widget) != LayoutInfo::NoLayout)
-            updateChildSelections(widget);
+            updateChildSelections(widget, &updated);
     }
 }
 
@@ -93,6 +93,7 @@ public:
     void setFileName(const QString &fileName) override;
 
     QString contents() const override;
+    DomUI *saveUi() const override;
     bool setContents(QIODevice *dev, QString *errorMessage = nullptr) override;
     bool setContents(const QString &) override;
 
@@ -118,7 +119,7 @@ public:
     void selectWidgets();
     void repaintSelection();
     void updateSelection(QWidget *w);
-    void updateChildSelections(QWidget *w);
+    void updateChildSelections(QWidget *w, QSet<QWidget *> *updated = nullptr);
     void raiseChildSelections(QWidget *w);
     void raiseSelection(QWidget *w);
 
@@ -309,6 +310,10 @@ private:
     class Selection;
     Selection *m_selection;
 
+    // Geometry of the managed widgets for rubber band selection
+    class GeometryIndex;
+    GeometryIndex *m_geometryIndex;
+
     QPoint m_startPos;
 
     QUndoStack m_undoStack;
@@ -450,6 +450,22 @@ void QDesignerResource::save(QIODevice *dev, QWidget *widget)
     QAbstractFormBuilder::save(dev, widget);
 }
 
+// Creates the DOM that save() writes, without writing it
+DomUI *QDesignerResource::saveUi(QWidget *widget)
+{
+    DomWidget *ui_widget = createDom(widget, nullptr);
+    Q_ASSERT(ui_widget != nullptr);
+
+    DomUI *ui = new DomUI();
+    ui->setAttributeVersion(QStringLiteral("4.0"));
+    ui->setElementWidget(ui_widget);
+
+    saveDom(ui, widget);
+
+    d->m_laidout.clear();
+    return ui;
+}
+
 void QDesignerResource::saveDom(DomUI *ui, QWidget *widget)
 {
     QAbstractFormBuilder::saveDom(ui, widget);
@@ -41,6 +41,7 @@ public:
     ~QDesignerResource() override;
 
     void save(QIODevice *dev, QWidget *widget) override;
+    DomUI *saveUi(QWidget *widget);
 
     bool copy(QIODevice *dev, const FormBuilderClipboard &selection) override;
     DomUI *copy(const FormBuilderClipboard &selection) override;
@@ -720,6 +720,8 @@ void PropertyEditor::updatePropertySheet()
 
     updateToolBarLabel();
 
+    // Update the items of the changed properties in one go
+    m_currentBrowser->beginUpdate();
     const int propertyCount = m_propertySheet->count();
     const  QMap<QString, QtVariantProperty*>::const_iterator npcend = m_nameToProperty.constEnd();
     for (int i = 0; i < propertyCount; ++i) {
@@ -728,6 +730,7 @@ void PropertyEditor::updatePropertySheet()
         if (it != npcend)
             updateBrowserValue(it.value(), m_propertySheet->property(i));
     }
+    m_currentBrowser->endUpdate();
 }
 
 static inline QLayout *layoutOfQLayoutWidget(QObject *o)
@@ -28,7 +28,7 @@ static const char *uiClosingTagC = "</ui>";
 
 QT_BEGIN_NAMESPACE
 
-enum { FilterRole = Qt::UserRole + 11 };
+enum { FilterRole = Qt::UserRole + 11, LowerCaseFilterRole = Qt::UserRole + 12 };
 
 static QString domToString(const QDomElement &elt)
 {
@@ -61,6 +61,7 @@ struct WidgetBoxCategoryEntry {
     QString toolTip;
     QString whatsThis;
     QString filter;
+    QString lowerCaseFilter;
     QIcon icon;
     bool editable{false};
 };
@@ -70,6 +71,7 @@ WidgetBoxCategoryEntry::WidgetBoxCategoryEntry(const QDesignerWidgetBoxInterface
                                                const QIcon &i, bool e) :
     widget(w),
     filter(filterIn),
+    lowerCaseFilter(filterIn.toLower()),
     icon(i),
     editable(e)
 {
@@ -237,6 +239,8 @@ QVariant WidgetBoxCategoryModel::data(const QModelIndex &index, int role) const
         return QVariant(item.whatsThis);
     case FilterRole:
         return item.filter;
+    case LowerCaseFilterRole:
+        return item.lowerCaseFilter;
     }
     return QVariant();
 }
@@ -333,11 +337,68 @@ QWidget *WidgetBoxCategoryEntryDelegate::createEditor(QWidget *parent,
     return result;
 }
 
+/* WidgetBoxCategoryFilterModel: Matches the filter strings of the entries,
+ * which are kept in lower case for case insensitive filtering. When the
+ * needle grows while typing, only the rows matching the previous needle
+ * are matched again. */
+
+class WidgetBoxCategoryFilterModel : public QSortFilterProxyModel
+{
+public:
+    using QSortFilterProxyModel::QSortFilterProxyModel;
+
+    void setFilter(const QString &needle, Qt::CaseSensitivity caseSensitivity);
+
+protected:
+    bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const override;
+
+private:
+    QString m_needle;
+    Qt::CaseSensitivity m_caseSensitivity = Qt::CaseInsensitive;
+    bool m_narrowing = false;
+    QList<bool> m_candidates; // by source row, while narrowing
+};
+
+void WidgetBoxCategoryFilterModel::setFilter(const QString &needleIn,
+                                             Qt::CaseSensitivity caseSensitivity)
+{
+    const QString needle = caseSensitivity == Qt::CaseInsensitive ? needleIn.toLower() : needleIn;
+    if (needle == m_needle && caseSensitivity == m_caseSensitivity)
+        return;
+
+    m_narrowing = caseSensitivity == m_caseSensitivity && !m_needle.isEmpty()
+        && needle.contains(m_needle);
+    if (m_narrowing) {
+        m_candidates.fill(false, sourceModel()->rowCount());
+        for (int row = 0, count = rowCount(); row < count; ++row)
+            m_candidates[mapToSource(index(row, 0)).row()] = true;
+    }
+
+    m_needle = needle;
+    m_caseSensitivity = caseSensitivity;
+    invalidateRowsFilter();
+
+    m_narrowing = false;
+    m_candidates.clear();
+}
+
+bool WidgetBoxCategoryFilterModel::filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const
+{
+    if (m_needle.isEmpty())
+        return true;
+    if (m_narrowing && sourceRow < m_candidates.size() && !m_candidates.at(sourceRow))
+        return false;
+
+    const int role = m_caseSensitivity == Qt::CaseInsensitive ? LowerCaseFilterRole : FilterRole;
+    const QModelIndex sourceIndex = sourceModel()->index(sourceRow, 0, sourceParent);
+    return sourceModel()->data(sourceIndex, role).toString().contains(m_needle);
+}
+
 // ----------------------  WidgetBoxCategoryListView
 
 WidgetBoxCategoryListView::WidgetBoxCategoryListView(QDesignerFormEditorInterface *core, QWidget *parent) :
     QListView(parent),
-    m_proxyModel(new QSortFilterProxyModel(this)),
+    m_proxyModel(new WidgetBoxCategoryFilterModel(this)),
     m_model(new WidgetBoxCategoryModel(core, this))
 {
     setFocusPolicy(Qt::NoFocus);
@@ -357,7 +418,6 @@ WidgetBoxCategoryListView::WidgetBoxCategoryListView(QDesignerFormEditorInterfac
     setEditTriggers(QAbstractItemView::AnyKeyPressed);
 
     m_proxyModel->setSourceModel(m_model);
-    m_proxyModel->setFilterRole(FilterRole);
     setModel(m_proxyModel);
     connect(m_model, &QAbstractItemModel::dataChanged,
             this, &WidgetBoxCategoryListView::scratchPadChanged);
@@ -462,8 +522,7 @@ QString WidgetBoxCategoryListView::widgetDomXml(const QDesignerWidgetBoxInterfac
 
 void WidgetBoxCategoryListView::filter(const QString &needle, Qt::CaseSensitivity caseSensitivity)
 {
-    m_proxyModel->setFilterFixedString(needle);
-    m_proxyModel->setFilterCaseSensitivity(caseSensitivity);
+    m_proxyModel->setFilter(needle, caseSensitivity);
 }
 
 QDesignerWidgetBoxInterface::Category WidgetBoxCategoryListView::category() const
@@ -14,11 +14,10 @@ QT_BEGIN_NAMESPACE
 class QDesignerFormEditorInterface;
 class QDesignerDnDItemInterface;
 
-class QSortFilterProxyModel;
-
 namespace qdesigner_internal {
 
 class WidgetBoxCategoryModel;
+class WidgetBoxCategoryFilterModel;
 
 // List view of a category, switchable between icon and list mode.
 // Provides a filtered view.
@@ -68,7 +67,7 @@ private slots:
 
 private:
     int mapRowToSource(int filterRow) const;
-    QSortFilterProxyModel *m_proxyModel;
+    WidgetBoxCategoryFilterModel *m_proxyModel;
     WidgetBoxCategoryModel *m_model;
 };
 
@@ -93,7 +93,11 @@ QIcon WidgetBoxTreeWidget::iconForWidget(const QString &iconName) const
         if (it != m_pluginIcons.constEnd())
             return it.value();
     }
-    return createIconSet(iconName);
+
+    IconCache::iterator it = m_resourceIcons.find(iconName);
+    if (it == m_resourceIcons.end())
+        it = m_resourceIcons.insert(iconName, createIconSet(iconName));
+    return it.value();
 }
 
 WidgetBoxCategoryListView *WidgetBoxTreeWidget::categoryViewAt(int idx) const
@@ -100,6 +100,7 @@ private:
     QString m_file_name;
     using IconCache = QHash<QString, QIcon>;
     mutable IconCache m_pluginIcons;
+    mutable IconCache m_resourceIcons; // icons loaded by name, shared by all entries
     bool m_iconMode;
     QTimer *m_scratchPadDeleteTimer;
 };
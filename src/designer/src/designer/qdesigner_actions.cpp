@@ -69,12 +69,20 @@
 #include <QtCore/qpluginloader.h>
 #include <QtCore/qdebug.h>
 #include <QtCore/qtimer.h>
-#include <QtCore/qtextstream.h>
 #include <QtCore/qmetaobject.h>
 #include <QtCore/qfileinfo.h>
 #include <QtCore/qsavefile.h>
 #include <QtCore/qscopedpointer.h>
-#include <QtXml/qdom.h>
+#include <QtCore/qrunnable.h>
+#include <QtCore/qset.h>
+#include <QtCore/qthreadpool.h>
+#include <QtCore/qxmlstream.h>
+#include <QtGui/qundostack.h>
+
+#include <QtDesigner/private/ui4_p.h>
+
+#include <memory>
+#include <vector>
 
 QT_BEGIN_NAMESPACE
 
@@ -130,6 +138,7 @@ QDesignerActions::QDesignerActions(QDesignerWorkbench *workbench)
       m_core(workbench->core()),
       m_settings(workbench->core()),
       m_backupTimer(new QTimer(this)),
+      m_backupThreadPool(new QThreadPool(this)),
       m_fileActions(createActionGroup(this)),
       m_recentFilesActions(createActionGroup(this)),
       m_editActions(createActionGroup(this)),
@@ -403,6 +412,7 @@ QDesignerActions::QDesignerActions(QDesignerWorkbench *workbench)
 
     activeFormWindowChanged(core()->formWindowManager()->activeFormWindow());
 
+    m_backupThreadPool->setMaxThreadCount(1);
     m_backupTimer->start(180000); // 3min
     connect(m_backupTimer, &QTimer::timeout, this, &QDesignerActions::backupForms);
 
@@ -458,6 +468,7 @@ QActionGroup *QDesignerActions::createHelpActions()
 
 QDesignerActions::~QDesignerActions()
 {
+    m_backupThreadPool->waitForDone();
 #ifdef HAS_PRINTER
     delete m_printer;
 #endif
@@ -1025,97 +1036,178 @@ void QDesignerActions::updateCloseAction()
     }
 }
 
+namespace {
+// Writes the form snapshots taken by QDesignerActions::backupForms() to the
+// backup directory, and removes the files of forms that are no longer open.
+class FormBackupWriter : public QRunnable
+{
+public:
+    FormBackupWriter(QObject *actions, const QString &backupPath, const QSet<QString> &fileNames)
+        : m_actions(actions), m_backupPath(backupPath), m_fileNames(fileNames) {}
+
+    void addForm(const QString &formName, const QString &fileName, DomUI *ui, bool crlf)
+    {
+        m_forms.push_back({formName, fileName, std::unique_ptr<DomUI>(ui), crlf});
+    }
+
+    void run() override;
+
+private:
+    struct Form
+    {
+        QString formName;
+        QString fileName;
+        std::unique_ptr<DomUI> ui;
+        bool crlf;
+    };
+
+    QObject *m_actions;
+    QString m_backupPath;
+    QSet<QString> m_fileNames;
+    std::vector<Form> m_forms;
+};
+
+void FormBackupWriter::run()
+{
+    for (const Form &form : m_forms) {
+        QByteArray contents;
+        QXmlStreamWriter writer(&contents);
+        writer.setAutoFormatting(true);
+        writer.setAutoFormattingIndent(1);
+        writer.writeStartDocument();
+        form.ui->write(writer);
+        writer.writeEndDocument();
+        if (form.crlf)
+            contents.replace("\n", "\r\n");
+
+        // QSaveFile replaces the previous backup only once the new one is on disk
+        QSaveFile file(form.fileName);
+        if (!file.open(QFile::WriteOnly) || file.write(contents) != contents.size()
+            || !file.commit()) {
+            designerWarning(QDesignerActions::tr("The backup file %1 could not be written.")
+                            .arg(form.fileName));
+            QMetaObject::invokeMethod(m_actions, "backupFailed", Qt::QueuedConnection,
+                                      Q_ARG(QString, form.formName),
+                                      Q_ARG(QString, form.fileName));
+        }
+    }
+
+    QDir backupDir(m_backupPath);
+    const QStringList backupFiles = backupDir.entryList(QDir::Files);
+    for (const QString &backupFile : backupFiles) {
+        if (!m_fileNames.contains(backupDir.filePath(backupFile)))
+            backupDir.remove(backupFile);
+    }
+}
+} // namespace
+
+/*
+  Backs up the forms that changed since the last backup. The forms are
+  converted to DOM snapshots here; writing them is left to a worker thread.
+*/
 void QDesignerActions::backupForms()
 {
     const int count = m_workbench->formWindowCount();
     if (!count || !ensureBackupDirectories())
         return;
 
+    QList<QDesignerFormWindowInterface *> forms;
+    for (int i = 0; i < count; ++i)
+        forms.append(m_workbench->formWindow(i)->editor());
+
+    // Forget about closed forms
+    QSet<QString> fileNames;
+    for (auto it = m_formBackups.begin(); it != m_formBackups.end(); ) {
+        if (it.value().form.isNull() || !forms.contains(it.key())) {
+            it = m_formBackups.erase(it);
+        } else {
+            fileNames.insert(it.value().fileName);
+            ++it;
+        }
+    }
 
-    QStringList tmpFiles;
     QMap<QString, QString> backupMap;
-    QDir backupDir(m_backupPath);
+    const QDir backupDir(m_backupPath);
+    QList<std::pair<QDesignerFormWindowInterface *, QString>> snapshots;
     for (int i = 0; i < count; ++i) {
         QDesignerFormWindow *fw = m_workbench->formWindow(i);
         QDesignerFormWindowInterface *fwi = fw->editor();
 
-        QString formBackupName;
-        QTextStream(&formBackupName) << m_backupPath << QDir::separator()
-                                     << QStringLiteral("backup") << i << QStringLiteral(".bak");
-
         QString fwn = QDir::toNativeSeparators(fwi->fileName());
         if (fwn.isEmpty())
             fwn = fw->windowTitle();
 
-        backupMap.insert(fwn, formBackupName);
-
-        QFile file(formBackupName.replace(m_backupPath, m_backupTmpPath));
-        if (file.open(QFile::WriteOnly)){
-            QString contents = fixResourceFileBackupPath(fwi, backupDir);
-            if (qdesigner_internal::FormWindowBase *fwb = qobject_cast<qdesigner_internal::FormWindowBase *>(fwi)) {
-                if (fwb->lineTerminatorMode() == qdesigner_internal::FormWindowBase::CRLFLineTerminator)
-                    contents.replace(QLatin1Char('\n'), QStringLiteral("\r\n"));
-            }
-            const QByteArray utf8Array = contents.toUtf8();
-            if (file.write(utf8Array, utf8Array.size()) != utf8Array.size()) {
-                backupMap.remove(fwn);
-                qdesigner_internal::designerWarning(tr("The backup file %1 could not be written.").arg(file.fileName()));
-            } else
-                tmpFiles.append(formBackupName);
-
-            file.close();
+        auto it = m_formBackups.find(fwi);
+        if (it == m_formBackups.end()) {
+            FormBackup backup;
+            backup.form = fwi;
+            for (int n = 0; backup.fileName.isEmpty() || fileNames.contains(backup.fileName); ++n)
+                backup.fileName = backupDir.filePath(u"backup"_s + QString::number(n) + u".bak"_s);
+            fileNames.insert(backup.fileName);
+            it = m_formBackups.insert(fwi, backup);
+
+            const auto markDirty = [this, fwi] {
+                const auto backup = m_formBackups.find(fwi);
+                if (backup != m_formBackups.end())
+                    backup.value().dirty = true;
+            };
+            connect(fwi->commandHistory(), &QUndoStack::indexChanged, this, markDirty);
+            connect(fwi, &QDesignerFormWindowInterface::fileNameChanged, this, markDirty);
         }
+        backupMap.insert(fwn, it.value().fileName);
+        if (it.value().dirty)
+            snapshots.append({fwi, fwn});
     }
-    if(!tmpFiles.isEmpty()) {
-        const QStringList backupFiles = backupDir.entryList(QDir::Files);
-        for (const QString &backupFile : backupFiles)
-            backupDir.remove(backupFile);
 
-        for (const QString &tmpName : qAsConst(tmpFiles)) {
-            QString name(tmpName);
-            name.replace(m_backupTmpPath, m_backupPath);
-            QFile tmpFile(tmpName);
-            if (!tmpFile.copy(name))
-                qdesigner_internal::designerWarning(tr("The backup file %1 could not be written.").arg(name));
-            tmpFile.remove();
+    auto *writer = new FormBackupWriter(this, m_backupPath, fileNames);
+    for (const auto &snapshot : qAsConst(snapshots)) {
+        QDesignerFormWindowInterface *fwi = snapshot.first;
+        FormBackup &backup = m_formBackups[fwi];
+        auto *fwb = qobject_cast<FormWindowBase *>(fwi);
+        DomUI *ui = fwb ? fwb->saveUi() : nullptr;
+        if (!ui) {
+            backupMap.remove(snapshot.second);
+            continue;
         }
+        fixResourceFileBackupPath(fwi, ui, backupDir);
+        writer->addForm(snapshot.second, backup.fileName, ui,
+                        fwb->lineTerminatorMode() == FormWindowBase::CRLFLineTerminator);
+        backup.dirty = false;
+    }
+    m_backupThreadPool->start(writer);
+
+    m_settings.setBackup(backupMap);
+}
 
+// Called when the backup file \a fileName of the form \a formName could not be written
+void QDesignerActions::backupFailed(const QString &formName, const QString &fileName)
+{
+    QMap<QString, QString> backupMap = m_settings.backup();
+    if (backupMap.value(formName) == fileName) {
+        backupMap.remove(formName);
         m_settings.setBackup(backupMap);
     }
+
+    for (FormBackup &backup : m_formBackups) {
+        if (backup.fileName == fileName)
+            backup.dirty = true;
+    }
 }
 
-QString QDesignerActions::fixResourceFileBackupPath(QDesignerFormWindowInterface *fwi, const QDir& backupDir)
+void QDesignerActions::fixResourceFileBackupPath(QDesignerFormWindowInterface *fwi, DomUI *ui,
+                                                 const QDir &backupDir)
 {
-    const QString content = fwi->contents();
-    QDomDocument domDoc(QStringLiteral("backup"));
-    if(!domDoc.setContent(content))
-        return content;
-
-    const QDomNodeList list = domDoc.elementsByTagName(QStringLiteral("resources"));
-    if (list.isEmpty())
-        return content;
-
-    for (int i = 0; i < list.count(); i++) {
-        const QDomNode node = list.at(i);
-        if (!node.isNull()) {
-            const QDomElement element = node.toElement();
-            if(!element.isNull() && element.tagName() == QStringLiteral("resources")) {
-                QDomNode childNode = element.firstChild();
-                while (!childNode.isNull()) {
-                    QDomElement childElement = childNode.toElement();
-                    if(!childElement.isNull() && childElement.tagName() == QStringLiteral("include")) {
-                        const QString attr = childElement.attribute(QStringLiteral("location"));
-                        const QString path = fwi->absoluteDir().absoluteFilePath(attr);
-                        childElement.setAttribute(QStringLiteral("location"), backupDir.relativeFilePath(path));
-                    }
-                    childNode = childNode.nextSibling();
-                }
-            }
+    DomResources *resources = ui->elementResources();
+    if (!resources)
+        return;
+
+    const QList<DomResource *> includes = resources->elementInclude();
+    for (DomResource *include : includes) {
+        if (include->hasAttributeLocation()) {
+            const QString path = fwi->absoluteDir().absoluteFilePath(include->attributeLocation());
+            include->setAttributeLocation(backupDir.relativeFilePath(path));
         }
     }
-
-
-    return domDoc.toString();
 }
 
 QRect QDesignerActions::fixDialogRect(const QRect &rect) const
@@ -1165,12 +1257,10 @@ bool QDesignerActions::ensureBackupDirectories() {
     if (m_backupPath.isEmpty()) {
         // create names
         m_backupPath = dataDirectory() + u"/backup"_s;
-        m_backupTmpPath = m_backupPath + u"/tmp"_s;
     }
 
-    // ensure directories
+    // ensure directory
     const QDir backupDir(m_backupPath);
-    const QDir backupTmpDir(m_backupTmpPath);
 
     if (!backupDir.exists()) {
         if (!backupDir.mkpath(m_backupPath)) {
@@ -1179,13 +1269,6 @@ bool QDesignerActions::ensureBackupDirectories() {
             return false;
         }
     }
-    if (!backupTmpDir.exists()) {
-        if (!backupTmpDir.mkpath(m_backupTmpPath)) {
-            qdesigner_internal::designerWarning(tr("The temporary backup directory %1 could not be created.")
-                                                .arg(QDir::toNativeSeparators(m_backupTmpPath)));
-            return false;
-        }
-    }
     return true;
 }
 
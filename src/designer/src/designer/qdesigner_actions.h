@@ -7,6 +7,7 @@
 #include "assistantclient.h"
 #include "qdesigner_settings.h"
 
+#include <QtCore/qhash.h>
 #include <QtCore/qobject.h>
 #include <QtCore/qpointer.h>
 
@@ -15,6 +16,7 @@ QT_BEGIN_NAMESPACE
 class QDesignerWorkbench;
 
 class QDir;
+class QThreadPool;
 class QTimer;
 class QAction;
 class QActionGroup;
@@ -27,6 +29,7 @@ class QWidget;
 class QPixmap;
 class QPrinter;
 class QMenu;
+class DomUI;
 
 namespace qdesigner_internal {
     class PreviewConfiguration;
@@ -104,6 +107,7 @@ private slots:
     void aboutDesigner();
     void showWidgetSpecificHelp();
     void backupForms();
+    void backupFailed(const QString &formName, const QString &fileName);
     void showNewFormDialog(const QString &fileName);
     void showPreferencesDialog();
     void showAppFontDialog();
@@ -121,7 +125,8 @@ private:
     void showHelp(const QString &help);
     void closePreview();
     QRect fixDialogRect(const QRect &rect) const;
-    QString fixResourceFileBackupPath(QDesignerFormWindowInterface *fwi, const QDir& backupDir);
+    void fixResourceFileBackupPath(QDesignerFormWindowInterface *fwi, DomUI *ui,
+                                   const QDir &backupDir);
     void showStatusBarMessage(const QString &message) const;
     QActionGroup *createHelpActions();
     bool ensureBackupDirectories();
@@ -139,9 +144,18 @@ private:
 
 
     QString m_backupPath;
-    QString m_backupTmpPath;
+
+    // Backup state of the open forms, to skip the unchanged ones
+    struct FormBackup
+    {
+        QPointer<QDesignerFormWindowInterface> form;
+        QString fileName;
+        bool dirty = true;
+    };
+    QHash<QDesignerFormWindowInterface *, FormBackup> m_formBackups;
 
     QTimer* m_backupTimer;
+    QThreadPool *m_backupThreadPool; // writes the backup files, one at a time
 
     QActionGroup *m_fileActions;
     QActionGroup *m_recentFilesActions;
@@ -17,6 +17,9 @@
 #include <QtGui/qtransform.h>
 
 #include <QtCore/qmap.h>
+#include <QtCore/qset.h>
+
+#include <algorithm>
 
 QT_BEGIN_NAMESPACE
 
@@ -27,6 +30,7 @@ static const int VLABEL_MARGIN =          1;
 static const int HLABEL_MARGIN =          3;
 static const int GROUND_W =              20;
 static const int GROUND_H =              25;
+static const int INDEX_CELL_SIZE =       64;
 
 /*******************************************************************************
 ** Tools
@@ -110,6 +114,7 @@ void AddConnectionCommand::redo()
     edit()->selectNone();
     emit edit()->aboutToAddConnection(edit()->m_con_list.size());
     edit()->m_con_list.append(m_con);
+    edit()->indexConnection(m_con);
     m_con->inserted();
     emit edit()->connectionAdded(m_con);
     edit()->setSelected(m_con, true);
@@ -123,6 +128,7 @@ void AddConnectionCommand::undo()
     m_con->update();
     m_con->removed();
     edit()->m_con_list.removeAll(m_con);
+    edit()->unindexConnection(m_con);
     emit edit()->connectionRemoved(idx);
 }
 
@@ -188,6 +194,7 @@ void DeleteConnectionsCommand::redo()
         con->update();
         con->removed();
         edit()->m_con_list.removeAll(con);
+        edit()->unindexConnection(con);
         emit edit()->connectionRemoved(idx);
     }
 }
@@ -198,6 +205,7 @@ void DeleteConnectionsCommand::undo()
         Q_ASSERT(!edit()->m_con_list.contains(con));
         emit edit()->aboutToAddConnection(edit()->m_con_list.size());
         edit()->m_con_list.append(con);
+        edit()->indexConnection(con);
         edit()->selectNone();
         con->update();
         con->inserted();
@@ -653,6 +661,7 @@ void Connection::setSource(QObject *source, const QPoint &pos)
         updateKneeList();
     }
 
+    m_edit->updateConnectionIndex(this);
     update(false);
 }
 
@@ -670,6 +679,7 @@ void Connection::setTarget(QObject *target, const QPoint &pos)
         updateKneeList();
     }
 
+    m_edit->updateConnectionIndex(this);
     update(false);
 }
 
@@ -748,6 +758,21 @@ bool Connection::contains(const QPoint &pos) const
     return region().contains(pos);
 }
 
+// The area painted for the connection: its region, the end points and the
+// highlighted widgets. The background widget is not highlighted.
+QRect Connection::boundingRect() const
+{
+    QRect result = region().boundingRect();
+    result |= endPointRect(EndPoint::Source);
+    result |= endPointRect(EndPoint::Target);
+    QWidget *bg = m_edit->background();
+    if (m_source != nullptr && m_source != bg)
+        result |= m_source_rect;
+    if (m_target != nullptr && m_target != bg)
+        result |= m_target_rect;
+    return result;
+}
+
 QRect Connection::endPointRect(EndPoint::Type type) const
 {
     if (type == EndPoint::Source) {
@@ -830,6 +855,7 @@ void Connection::setLabel(EndPoint::Type type, const QString &text)
         m_target_label = text;
 
     updatePixmap(type);
+    m_edit->updateConnectionIndex(this);
 }
 
 void Connection::updatePixmap(EndPoint::Type type)
@@ -893,6 +919,7 @@ void Connection::checkWidgets()
     if (changed) {
         update();
         updateKneeList();
+        m_edit->updateConnectionIndex(this);
         update();
     }
 }
@@ -927,6 +954,8 @@ ConnectionEdit::~ConnectionEdit()
 void ConnectionEdit::clear()
 {
     m_con_list.clear();
+    m_con_grid.clear();
+    m_con_index.clear();
     m_sel_con_set.clear();
     m_bg_widget = nullptr;
     m_widget_under_mouse = nullptr;
@@ -964,6 +993,8 @@ void ConnectionEdit::updateBackground()
         c->updateVisibility();
 
     updateLines();
+    // Whether a connection highlights its widgets depends on the background
+    rebuildConnectionIndex();
     update();
 }
 
@@ -1038,7 +1069,10 @@ void ConnectionEdit::paintEvent(QPaintEvent *e)
 
     WidgetSet heavy_highlight_set, light_highlight_set;
 
-    for (Connection *con : qAsConst(m_con_list)) {
+    // Only the connections that can paint into the exposed area, in list order
+    const ConnectionList con_list = connectionsIn(e->region().boundingRect());
+
+    for (Connection *con : con_list) {
         if (!con->isVisible())
             continue;
 
@@ -1071,7 +1105,7 @@ void ConnectionEdit::paintEvent(QPaintEvent *e)
 
     p.setBrush(palette().color(QPalette::Base));
     p.setPen(palette().color(QPalette::Text));
-    for (Connection *con : qAsConst(m_con_list)) {
+    for (Connection *con : con_list) {
         if (con->isVisible()) {
             paintLabel(&p, EndPoint::Source, con);
             paintLabel(&p, EndPoint::Target, con);
@@ -1081,7 +1115,7 @@ void ConnectionEdit::paintEvent(QPaintEvent *e)
     p.setPen(m_active_color);
     p.setBrush(m_active_color);
 
-    for (Connection *con : qAsConst(m_con_list)) {
+    for (Connection *con : con_list) {
         if (!selected(con) || !con->isVisible())
             continue;
 
@@ -1418,7 +1452,7 @@ void ConnectionEdit::selectAll()
 
 Connection *ConnectionEdit::connectionAt(const QPoint &pos) const
 {
-    for (Connection *con : m_con_list) {
+    for (Connection *con : connectionsIn(QRect(pos, QSize(1, 1)))) {
         if (con->contains(pos))
             return con;
     }
@@ -1427,9 +1461,10 @@ Connection *ConnectionEdit::connectionAt(const QPoint &pos) const
 
 CETypes::EndPoint ConnectionEdit::endPointAt(const QPoint &pos) const
 {
-    for (Connection *con : m_con_list) {
-        if (!selected(con))
-            continue;
+    // Only selected connections show their end points
+    const ConnectionList con_list
+        = sortedConnections(ConnectionList(m_sel_con_set.cbegin(), m_sel_con_set.cend()));
+    for (Connection *con : con_list) {
         const QRect sr = con->endPointRect(EndPoint::Source);
         const QRect tr = con->endPointRect(EndPoint::Target);
 
@@ -1484,9 +1519,118 @@ void ConnectionEdit::deleteSelected()
     m_undo_stack->push(cmd);
 }
 
+static inline int indexCell(int coordinate)
+{
+    // Round towards negative infinity, connections may extend beyond the edges
+    return coordinate >= 0 ? coordinate / INDEX_CELL_SIZE
+                           : (coordinate + 1) / INDEX_CELL_SIZE - 1;
+}
+
+static inline quint64 indexCellKey(int x, int y)
+{
+    return (quint64(quint32(x)) << 32) | quint32(y);
+}
+
+// (Re)inserts a connection of m_con_list into the grid under its bounding rectangle.
+void ConnectionEdit::indexConnection(Connection *con)
+{
+    IndexEntry entry;
+    const auto it = m_con_index.constFind(con);
+    if (it != m_con_index.constEnd()) {
+        entry.order = it.value().order;
+        unindexConnection(con);
+    } else {
+        entry.order = m_con_order++;
+    }
+
+    const QRect rect = con->boundingRect();
+    if (!rect.isEmpty()) {
+        entry.cells = QRect(QPoint(indexCell(rect.left()), indexCell(rect.top())),
+                            QPoint(indexCell(rect.right()), indexCell(rect.bottom())));
+        for (int y = entry.cells.top(); y <= entry.cells.bottom(); ++y) {
+            for (int x = entry.cells.left(); x <= entry.cells.right(); ++x)
+                m_con_grid[indexCellKey(x, y)].append(con);
+        }
+    }
+    m_con_index.insert(con, entry);
+}
+
+void ConnectionEdit::unindexConnection(Connection *con)
+{
+    const auto it = m_con_index.find(con);
+    if (it == m_con_index.end())
+        return;
+
+    const QRect cells = it.value().cells;
+    for (int y = cells.top(); y <= cells.bottom(); ++y) {
+        for (int x = cells.left(); x <= cells.right(); ++x) {
+            const auto cell = m_con_grid.find(indexCellKey(x, y));
+            if (cell == m_con_grid.end())
+                continue;
+            cell.value().removeOne(con);
+            if (cell.value().isEmpty())
+                m_con_grid.erase(cell);
+        }
+    }
+    m_con_index.erase(it);
+}
+
+// Called by connections whose geometry changed. Connections that are not
+// (yet) in m_con_list, such as the one being created, are not indexed.
+void ConnectionEdit::updateConnectionIndex(Connection *con)
+{
+    if (m_con_index.contains(con))
+        indexConnection(con);
+}
+
+void ConnectionEdit::rebuildConnectionIndex()
+{
+    for (Connection *con : qAsConst(m_con_list))
+        indexConnection(con);
+}
+
+// Returns the connections whose bounding rectangles intersect the cells
+// covering rect, in the order of m_con_list.
+ConnectionEdit::ConnectionList ConnectionEdit::connectionsIn(const QRect &rect) const
+{
+    if (rect.isEmpty() || m_con_grid.isEmpty())
+        return ConnectionList();
+
+    const int left = indexCell(rect.left());
+    const int right = indexCell(rect.right());
+    const int top = indexCell(rect.top());
+    const int bottom = indexCell(rect.bottom());
+
+    QSet<Connection *> seen;
+    ConnectionList result;
+    for (int y = top; y <= bottom; ++y) {
+        for (int x = left; x <= right; ++x) {
+            const auto cell = m_con_grid.constFind(indexCellKey(x, y));
+            if (cell == m_con_grid.constEnd())
+                continue;
+            for (Connection *con : cell.value()) {
+                if (!seen.contains(con)) {
+                    seen.insert(con);
+                    result.append(con);
+                }
+            }
+        }
+    }
+    return sortedConnections(result);
+}
+
+ConnectionEdit::ConnectionList ConnectionEdit::sortedConnections(ConnectionList list) const
+{
+    std::sort(list.begin(), list.end(), [this](Connection *c1, Connection *c2) {
+        return m_con_index.value(c1).order < m_con_index.value(c2).order;
+    });
+    return list;
+}
+
 void ConnectionEdit::addConnection(Connection *con)
 {
     m_con_list.append(con);
+    indexConnection(con);
 }
 
 void ConnectionEdit::updateLines()
@@ -1534,6 +1678,7 @@ Connection *ConnectionEdit::takeConnection(Connection *con)
     if (!m_con_list.contains(con))
         return nullptr;
     m_con_list.removeAll(con);
+    unindexConnection(con);
     return con;
 }
 
@@ -85,6 +85,7 @@ public:
     void setVisible(bool b);
 
     virtual QRegion region() const;
+    QRect boundingRect() const;
     bool contains(const QPoint &pos) const;
     virtual void paint(QPainter *p) const;
 
@@ -220,6 +221,12 @@ private:
                          WidgetSet *light_highlight_set) const;
     void paintLabel(QPainter *p, EndPoint::Type type, Connection *con);
 
+    void indexConnection(Connection *con);
+    void unindexConnection(Connection *con);
+    void updateConnectionIndex(Connection *con);
+    void rebuildConnectionIndex();
+    ConnectionList connectionsIn(const QRect &rect) const;
+    ConnectionList sortedConnections(ConnectionList list) const;
 
     QPointer<QWidget> m_bg_widget;
     QUndoStack *m_undo_stack;
@@ -227,6 +234,16 @@ private:
 
     Connection *m_tmp_con; // the connection we are currently editing
     ConnectionList m_con_list;
+
+    // Grid of the bounding rectangles of the connections in m_con_list,
+    // for hit testing and painting
+    struct IndexEntry {
+        QRect cells; // the cells covered, null if the connection covers nothing
+        quint64 order = 0; // position in m_con_list, connections are only appended
+    };
+    QHash<quint64, ConnectionList> m_con_grid;
+    QHash<Connection *, IndexEntry> m_con_index;
+    quint64 m_con_order = 0;
     bool m_start_connection_on_drag;
     EndPoint m_end_point_under_mouse;
     QPointer<QWidget> m_widget_under_mouse;
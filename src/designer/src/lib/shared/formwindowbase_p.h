@@ -25,6 +25,7 @@
 QT_BEGIN_NAMESPACE
 
 class QDesignerDnDItemInterface;
+class DomUI;
 class QMenu;
 class QtResourceSet;
 class QDesignerPropertySheet;
@@ -105,6 +106,9 @@ public:
     // Factory method to create a form builder
     virtual QEditorFormBuilder *createFormBuilder() = 0;
 
+    // Snapshot of the form as saved by contents(), owned by the caller
+    virtual DomUI *saveUi() const = 0;
+
     virtual bool blockSelectionChanged(bool blocked) = 0;
 
     DesignerPixmapCache *pixmapCache() const;
@@ -2410,6 +2410,45 @@ bool TableWidgetContents::operator==(const TableWidgetContents &rhs) const
            m_items == rhs.m_items;
 }
 
+// The contents commands keep the states before and after an edit, which
+// mostly consist of the same items. Unchanged items of the new state share
+// their (implicitly shared) data with the old state, so that a command
+// effectively only holds the items that changed.
+
+static void shareUnchanged(const ListContents &oldContents, ListContents *newContents)
+{
+    if (oldContents.m_items == newContents->m_items) {
+        newContents->m_items = oldContents.m_items;
+        return;
+    }
+    const qsizetype count = qMin(oldContents.m_items.size(), newContents->m_items.size());
+    for (qsizetype i = 0; i < count; ++i) {
+        if (oldContents.m_items.at(i) == newContents->m_items.at(i))
+            newContents->m_items[i] = oldContents.m_items.at(i);
+    }
+}
+
+static qsizetype itemDataSize(const ItemData &itemData)
+{
+    return qsizetype(sizeof(ItemData))
+            + itemData.m_properties.size() * qsizetype(sizeof(int) + sizeof(QVariant));
+}
+
+// Size of newItems, not counting the items sharing their data with oldItems
+static qsizetype itemsSize(const QList<ItemData> &newItems,
+                           const QList<ItemData> &oldItems = QList<ItemData>())
+{
+    if (!newItems.isEmpty() && newItems.isSharedWith(oldItems))
+        return 0;
+    qsizetype result = 0;
+    for (qsizetype i = 0, count = newItems.size(); i < count; ++i) {
+        const ItemData &item = newItems.at(i);
+        if (i >= oldItems.size() || !item.m_properties.isSharedWith(oldItems.at(i).m_properties))
+            result += itemDataSize(item);
+    }
+    return result;
+}
+
 // ---- ChangeTableContentsCommand ----
 ChangeTableContentsCommand::ChangeTableContentsCommand(QDesignerFormWindowInterface *formWindow)  :
     QDesignerFormWindowCommand(QApplication::translate("Command", "Change Table Contents"),
@@ -2426,6 +2465,43 @@ void ChangeTableContentsCommand::init(QTableWidget *tableWidget,
     m_tableWidget = tableWidget;
     m_oldContents = oldCont;
     m_newContents = newCont;
+
+    shareUnchanged(m_oldContents.m_horizontalHeader, &m_newContents.m_horizontalHeader);
+    shareUnchanged(m_oldContents.m_verticalHeader, &m_newContents.m_verticalHeader);
+    if (m_oldContents.m_items == m_newContents.m_items) {
+        m_newContents.m_items = m_oldContents.m_items;
+    } else {
+        for (auto it = m_newContents.m_items.begin(), end = m_newContents.m_items.end(); it != end; ++it) {
+            const auto oldIt = m_oldContents.m_items.constFind(it.key());
+            if (oldIt != m_oldContents.m_items.constEnd() && oldIt.value() == it.value())
+                it.value() = oldIt.value();
+        }
+    }
+}
+
+qsizetype ChangeTableContentsCommand::memoryUsage() const
+{
+    qsizetype result = QDesignerFormWindowCommand::memoryUsage();
+    for (const TableWidgetContents *contents : {&m_oldContents, &m_newContents}) {
+        const bool isNew = contents == &m_newContents;
+        result += itemsSize(contents->m_horizontalHeader.m_items,
+                            isNew ? m_oldContents.m_horizontalHeader.m_items : QList<ItemData>());
+        result += itemsSize(contents->m_verticalHeader.m_items,
+                            isNew ? m_oldContents.m_verticalHeader.m_items : QList<ItemData>());
+        if (isNew && m_newContents.m_items.isSharedWith(m_oldContents.m_items))
+            continue;
+        for (auto it = contents->m_items.cbegin(), end = contents->m_items.cend(); it != end; ++it) {
+            if (isNew) {
+                const auto oldIt = m_oldContents.m_items.constFind(it.key());
+                if (oldIt != m_oldContents.m_items.constEnd()
+                    && oldIt.value().m_properties.isSharedWith(it.value().m_properties)) {
+                    continue;
+                }
+            }
+            result += itemDataSize(it.value());
+        }
+    }
+    return result;
 }
 
 void ChangeTableContentsCommand::redo()
@@ -2517,6 +2593,46 @@ bool TreeWidgetContents::operator==(const TreeWidgetContents &rhs) const
         m_rootItems == rhs.m_rootItems;
 }
 
+using TreeItemContentsList = QList<TreeWidgetContents::ItemContents>;
+
+static void shareUnchangedTreeItems(const TreeItemContentsList &oldItems, TreeItemContentsList *newItems)
+{
+    if (oldItems == *newItems) {
+        *newItems = oldItems;
+        return;
+    }
+    const qsizetype count = qMin(oldItems.size(), newItems->size());
+    for (qsizetype i = 0; i < count; ++i) {
+        const TreeWidgetContents::ItemContents &oldItem = oldItems.at(i);
+        TreeWidgetContents::ItemContents &newItem = (*newItems)[i];
+        if (oldItem == newItem) {
+            newItem = oldItem;
+        } else {
+            shareUnchanged(oldItem, &newItem);
+            shareUnchangedTreeItems(oldItem.m_children, &newItem.m_children);
+        }
+    }
+}
+
+static qsizetype treeItemsSize(const TreeItemContentsList &newItems,
+                               const TreeItemContentsList &oldItems = TreeItemContentsList())
+{
+    if (!newItems.isEmpty() && newItems.isSharedWith(oldItems))
+        return 0;
+    qsizetype result = 0;
+    for (qsizetype i = 0, count = newItems.size(); i < count; ++i) {
+        const TreeWidgetContents::ItemContents &item = newItems.at(i);
+        if (i < oldItems.size()) {
+            const TreeWidgetContents::ItemContents &oldItem = oldItems.at(i);
+            result += itemsSize(item.m_items, oldItem.m_items)
+                    + treeItemsSize(item.m_children, oldItem.m_children);
+        } else {
+            result += itemsSize(item.m_items) + treeItemsSize(item.m_children);
+        }
+    }
+    return result;
+}
+
 // ---- ChangeTreeContentsCommand ----
 ChangeTreeContentsCommand::ChangeTreeContentsCommand(QDesignerFormWindowInterface *formWindow)
     : QDesignerFormWindowCommand(QApplication::translate("Command", "Change Tree Contents"), formWindow),
@@ -2533,6 +2649,18 @@ void ChangeTreeContentsCommand::init(QTreeWidget *treeWidget,
     m_treeWidget = treeWidget;
     m_oldState = oldState;
     m_newState = newState;
+
+    shareUnchanged(m_oldState.m_headerItem, &m_newState.m_headerItem);
+    shareUnchangedTreeItems(m_oldState.m_rootItems, &m_newState.m_rootItems);
+}
+
+qsizetype ChangeTreeContentsCommand::memoryUsage() const
+{
+    return QDesignerFormWindowCommand::memoryUsage()
+            + itemsSize(m_oldState.m_headerItem.m_items)
+            + itemsSize(m_newState.m_headerItem.m_items, m_oldState.m_headerItem.m_items)
+            + treeItemsSize(m_oldState.m_rootItems)
+            + treeItemsSize(m_newState.m_rootItems, m_oldState.m_rootItems);
 }
 
 void ChangeTreeContentsCommand::redo()
@@ -2562,6 +2690,7 @@ void ChangeListContentsCommand::init(QListWidget *listWidget,
 
     m_newItemsState = items;
     m_oldItemsState = oldItems;
+    shareUnchanged(m_oldItemsState, &m_newItemsState);
 }
 
 void ChangeListContentsCommand::init(QComboBox *comboBox,
@@ -2572,6 +2701,14 @@ void ChangeListContentsCommand::init(QComboBox *comboBox,
 
     m_newItemsState = items;
     m_oldItemsState = oldItems;
+    shareUnchanged(m_oldItemsState, &m_newItemsState);
+}
+
+qsizetype ChangeListContentsCommand::memoryUsage() const
+{
+    return QDesignerFormWindowCommand::memoryUsage()
+            + itemsSize(m_oldItemsState.m_items)
+            + itemsSize(m_newItemsState.m_items, m_oldItemsState.m_items);
 }
 
 void ChangeListContentsCommand::redo()
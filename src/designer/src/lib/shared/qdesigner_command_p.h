@@ -888,6 +888,7 @@ public:
     void init(QTableWidget *tableWidget, const TableWidgetContents &oldCont, const TableWidgetContents &newCont);
     void redo() override;
     void undo() override;
+    qsizetype memoryUsage() const override;
 
 private:
     QPointer<QTableWidget> m_tableWidget;
@@ -936,6 +937,7 @@ public:
     void init(QTreeWidget *treeWidget, const TreeWidgetContents &oldState, const TreeWidgetContents &newState);
     void redo() override;
     void undo() override;
+    qsizetype memoryUsage() const override;
     enum ApplyIconStrategy {
         SetIconStrategy,
         ResetIconStrategy
@@ -957,6 +959,7 @@ public:
     void init(QComboBox *comboBox, const ListContents &oldItems, const ListContents &items);
     void redo() override;
     void undo() override;
+    qsizetype memoryUsage() const override;
 private:
     QPointer<QListWidget> m_listWidget;
     QPointer<QComboBox> m_comboBox;
@@ -55,6 +55,31 @@ void QDesignerFormWindowCommand::redo()
     cheapUpdate();
 }
 
+qsizetype QDesignerFormWindowCommand::memoryUsage() const
+{
+    qsizetype result = qsizetype(sizeof(QDesignerFormWindowCommand))
+            + text().size() * qsizetype(sizeof(QChar));
+    for (int i = 0, count = childCount(); i < count; ++i) {
+        if (auto *command = dynamic_cast<const QDesignerFormWindowCommand *>(child(i)))
+            result += command->memoryUsage();
+        else
+            result += qsizetype(sizeof(QUndoCommand));
+    }
+    return result;
+}
+
+qsizetype QDesignerFormWindowCommand::memoryUsage(const QUndoStack *stack)
+{
+    qsizetype result = 0;
+    for (int i = 0, count = stack->count(); i < count; ++i) {
+        if (auto *command = dynamic_cast<const QDesignerFormWindowCommand *>(stack->command(i)))
+            result += command->memoryUsage();
+        else
+            result += qsizetype(sizeof(QUndoCommand));
+    }
+    return result;
+}
+
 void QDesignerFormWindowCommand::cheapUpdate()
 {
     if (core()->objectInspector())
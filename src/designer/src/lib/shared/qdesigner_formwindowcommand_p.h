@@ -40,6 +40,10 @@ public:
     void undo() override;
     void redo() override;
 
+    // Rough estimate of the memory held by the command and its children
+    virtual qsizetype memoryUsage() const;
+    static qsizetype memoryUsage(const QUndoStack *stack);
+
     static void updateBuddies(QDesignerFormWindowInterface *form,
                               const QString &old_name, const QString &new_name);
 protected:
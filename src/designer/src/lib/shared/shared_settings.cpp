@@ -27,6 +27,7 @@ static const char *enabledKey = "Enabled";
 static const char *userDeviceSkinsKey= "UserDeviceSkins";
 static const char *zoomKey = "zoom";
 static const char *zoomEnabledKey = "zoomEnabled";
+static const char *undoLimitKey = "UndoLimit";
 static const char *deviceProfileIndexKey = "DeviceProfileIndex";
 static const char *deviceProfilesKey = "DeviceProfiles";
 static const char *formTemplatePathsKey = "FormTemplatePaths";
@@ -225,6 +226,16 @@ void QDesignerSharedSettings::setZoom(int z)
     m_settings->setValue(QLatin1String(zoomKey), QVariant(z));
 }
 
+int QDesignerSharedSettings::undoLimit() const
+{
+    return qMax(0, m_settings->value(QLatin1String(undoLimitKey), 0).toInt());
+}
+
+void QDesignerSharedSettings::setUndoLimit(int l)
+{
+    m_settings->setValue(QLatin1String(undoLimitKey), QVariant(l));
+}
+
 ObjectNamingMode QDesignerSharedSettings::objectNamingMode() const
 {
     const QString value = m_settings->value(namingModeKey()).toString();
@@ -78,6 +78,10 @@ public:
     int zoom() const;
     void setZoom(int z);
 
+    // Maximum number of commands in the undo history of a form, 0 for no limit
+    int undoLimit() const;
+    void setUndoLimit(int l);
+
     // Object naming convention (ActionEditor)
     ObjectNamingMode objectNamingMode() const;
     void setObjectNamingMode(ObjectNamingMode n);
@@ -0,0 +1,66 @@
+// Copyright (C) 2022 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#ifndef DISTANCEFIELDFONTWRITER_H
+#define DISTANCEFIELDFONTWRITER_H
+
+#include <QtCore/qcoreapplication.h>
+#include <QtCore/qlist.h>
+#include <QtGui/qimage.h>
+#include <QtGui/qpainterpath.h>
+#include <QtGui/private/qtextengine_p.h>
+
+QT_BEGIN_NAMESPACE
+
+// Writes a copy of a font file with an added 'qtdf' table holding the
+// pregenerated distance fields of a set of glyphs.
+class DistanceFieldFontWriter
+{
+    Q_DECLARE_TR_FUNCTIONS(DistanceFieldFontWriter)
+public:
+    enum PackingOrder {
+        GivenOrder,                 // allocate the glyphs in the order they are passed
+        HeightOrder,                // tallest glyphs first
+        UnicodeRangeAndHeightOrder  // by Unicode range, then tallest glyphs first
+    };
+
+    struct Glyph
+    {
+        glyph_t glyphIndex = 0;
+        QImage distanceField;
+        QPainterPath path;
+        quint32 unicodeRange = 0; // start of the Unicode range, for UnicodeRangeAndHeightOrder
+    };
+
+    DistanceFieldFontWriter(qreal pixelSize, bool doubleGlyphResolution, quint32 maximumTextureSize);
+
+    QByteArray createFont(const QString &fontFile, const QList<Glyph> &glyphs);
+    bool writeFont(const QString &fontFile, const QString &outputFile, const QList<Glyph> &glyphs);
+
+    void setPackingOrder(PackingOrder order) { m_packingOrder = order; }
+    PackingOrder packingOrder() const { return m_packingOrder; }
+
+    // Statistics of the last created font
+    int textureCount() const { return m_textureCount; }
+    qreal packingEfficiency() const { return m_packingEfficiency; }
+
+    QString errorTitle() const { return m_errorTitle; }
+    QString errorString() const { return m_errorString; }
+
+private:
+    QByteArray createSfntTable(const QList<Glyph> &glyphs);
+    void setError(const QString &title, const QString &errorString);
+
+    qreal m_pixelSize;
+    bool m_doubleGlyphResolution;
+    quint32 m_maximumTextureSize;
+    PackingOrder m_packingOrder;
+    int m_textureCount;
+    qreal m_packingEfficiency; // glyph area divided by the stored texture area
+    QString m_errorTitle;
+    QString m_errorString;
+};
+
+QT_END_NAMESPACE
+
+#endif // DISTANCEFIELDFONTWRITER_H
@@ -113,12 +113,12 @@ void DistanceFieldModel::reserveSpace(quint16 glyphCount,
                               Qt::QueuedConnection);
 }
 
-DistanceFieldModel::UnicodeRange DistanceFieldModel::unicodeRangeForUcs4(quint32 ucs4) const
+DistanceFieldModel::UnicodeRange DistanceFieldModel::unicodeRangeForUcs4(quint32 ucs4)
 {
-    int index = metaObject()->indexOfEnumerator("UnicodeRange");
+    int index = staticMetaObject.indexOfEnumerator("UnicodeRange");
     Q_ASSERT(index >= 0);
 
-    QMetaEnum range = metaObject()->enumerator(index);
+    QMetaEnum range = staticMetaObject.enumerator(index);
     for (int i = 0; i < range.keyCount() - 1; ++i) {
         int rangeStart = range.value(i);
         int rangeEnd = range.value(i + 1);
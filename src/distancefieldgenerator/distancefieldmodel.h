@@ -163,6 +163,7 @@ public:
     QList<glyph_t> glyphIndexesForUnicodeRange(UnicodeRange range) const;
     QString nameForUnicodeRange(UnicodeRange range) const;
     glyph_t glyphIndexForUcs4(quint32 ucs4) const;
+    static UnicodeRange unicodeRangeForUcs4(quint32 ucs4);
 
     QImage distanceField(int row) const
     {
@@ -193,8 +194,6 @@ private slots:
                       qreal pixelSize);
 
 private:
-    UnicodeRange unicodeRangeForUcs4(quint32 ucs4) const;
-
     QRawFont m_font;
     DistanceFieldModelWorker *m_worker;
     QScopedPointer<QThread> m_workerThread;
@@ -30,6 +30,11 @@ public:
     void readCmapSubtable(const CmapSubtable10 *subtable, const void *end);
     void readCmapSubtable(const CmapSubtable12 *subtable, const void *end);
 
+    const QRawFont &font() const { return m_font; }
+    quint16 glyphCount() const { return m_glyphCount; }
+    bool doubleGlyphResolution() const { return m_doubleGlyphResolution; }
+    quint32 cmapAssignment(glyph_t glyphId) const { return m_cmapping.value(glyphId); }
+
 signals:
     void fontLoaded(quint16 glyphCount, bool doubleResolution, qreal pixelSize);
     void fontGenerated();
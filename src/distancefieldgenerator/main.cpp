@@ -2,19 +2,117 @@
 // SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
 
 #include "mainwindow.h"
+#include "distancefieldfontwriter.h"
+#include "distancefieldmodel.h"
+#include "distancefieldmodelworker.h"
 
 #include <QApplication>
 #include <QCommandLineParser>
+#include <QScopedPointer>
+#include <QThreadPool>
+
+#include <QtGui/private/qdistancefield_p.h>
+
+#include <algorithm>
 
 QT_USE_NAMESPACE
 
-int main(int argc, char **argv)
+// Glyphs are handed to the thread pool in chunks of this size
+static const qsizetype GlyphsPerTask = 64;
+
+/*
+  Generates the distance fields for the glyphs of \a fontFile that are
+  used by \a characters, or for all glyphs if \a characters is empty, and
+  writes the font with the added table to \a outputFile.
+
+  The glyph outlines are read on the calling thread, since QRawFont is not
+  thread-safe. The distance fields only depend on the outlines and are
+  rendered on all cores.
+*/
+static int generateFont(const QString &fontFile, const QString &outputFile,
+                        quint32 maximumTextureSize, const QString &characters, int jobs,
+                        DistanceFieldFontWriter::PackingOrder packingOrder)
 {
-    QApplication app(argc, argv);
-    app.setOrganizationName(QStringLiteral("QtProject"));
-    app.setApplicationName(QStringLiteral("Qt Distance Field Generator"));
-    app.setApplicationVersion(QStringLiteral(QT_VERSION_STR));
+    DistanceFieldModelWorker worker;
+    QObject::connect(&worker, &DistanceFieldModelWorker::error,
+                     [](const QString &errorString) {
+        qWarning("%s", qPrintable(errorString));
+    });
+    worker.loadFont(fontFile);
+    if (!worker.font().isValid())
+        return 1;
+
+    QList<glyph_t> glyphIndexes;
+    if (characters.isEmpty()) {
+        glyphIndexes.reserve(worker.glyphCount());
+        for (quint16 glyphIndex = 0; glyphIndex < worker.glyphCount(); ++glyphIndex)
+            glyphIndexes.append(glyphIndex);
+    } else {
+        const QList<quint32> indexes = worker.font().glyphIndexesForString(characters);
+        for (quint32 glyphIndex : indexes) {
+            if (glyphIndex != 0)
+                glyphIndexes.append(glyphIndex);
+        }
+        std::sort(glyphIndexes.begin(), glyphIndexes.end());
+        glyphIndexes.erase(std::unique(glyphIndexes.begin(), glyphIndexes.end()),
+                           glyphIndexes.end());
+    }
+
+    if (glyphIndexes.isEmpty()) {
+        qWarning("%s", qPrintable(QCoreApplication::translate("main",
+                                                              "No glyphs to generate.")));
+        return 1;
+    }
+
+    QList<DistanceFieldFontWriter::Glyph> glyphs(glyphIndexes.size());
+    for (qsizetype i = 0; i < glyphIndexes.size(); ++i) {
+        glyphs[i].glyphIndex = glyphIndexes.at(i);
+        glyphs[i].path = worker.font().pathForGlyph(glyphIndexes.at(i));
+        if (const quint32 ucs4 = worker.cmapAssignment(glyphIndexes.at(i)))
+            glyphs[i].unicodeRange = DistanceFieldModel::unicodeRangeForUcs4(ucs4);
+    }
+
+    {
+        const bool doubleGlyphResolution = worker.doubleGlyphResolution();
+        DistanceFieldFontWriter::Glyph *data = glyphs.data();
+        const qsizetype count = glyphs.size();
+
+        QThreadPool pool;
+        if (jobs > 0)
+            pool.setMaxThreadCount(jobs);
+        for (qsizetype first = 0; first < count; first += GlyphsPerTask) {
+            const qsizetype last = qMin(first + GlyphsPerTask, count);
+            pool.start([data, first, last, doubleGlyphResolution] {
+                for (qsizetype i = first; i < last; ++i) {
+                    QDistanceField distanceField(data[i].path, data[i].glyphIndex,
+                                                 doubleGlyphResolution);
+                    data[i].distanceField = distanceField.toImage(QImage::Format_Alpha8);
+                }
+            });
+        }
+        pool.waitForDone();
+    }
+
+    DistanceFieldFontWriter writer(worker.font().pixelSize(),
+                                   worker.doubleGlyphResolution(),
+                                   maximumTextureSize);
+    writer.setPackingOrder(packingOrder);
+    if (!writer.writeFont(fontFile, outputFile, glyphs)) {
+        qWarning("%s: %s", qPrintable(writer.errorTitle()), qPrintable(writer.errorString()));
+        return 1;
+    }
+
+    qInfo("%s", qPrintable(QCoreApplication::translate("main",
+                                                       "%n glyph(s) in %1 texture(s), %2% of the "
+                                                       "texture area used.", nullptr, glyphs.size())
+                           .arg(writer.textureCount())
+                           .arg(qRound(writer.packingEfficiency() * 100))));
 
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
     QCommandLineParser parser;
     parser.setApplicationDescription(
                 QCoreApplication::translate("main",
@@ -24,12 +122,114 @@ int main(int argc, char **argv)
     parser.addPositionalArgument(QLatin1String("file"),
                                  QCoreApplication::translate("main",
                                                              "Font file (*.ttf, *.otf)"));
-    parser.process(app);
+
+    QCommandLineOption outputOption({ QStringLiteral("o"), QStringLiteral("output") },
+                                    QCoreApplication::translate("main",
+                                                                "Generate the distance fields without "
+                                                                "showing the user interface and save "
+                                                                "the font to <output>."),
+                                    QStringLiteral("output"));
+    parser.addOption(outputOption);
+    QCommandLineOption charactersOption(QStringLiteral("characters"),
+                                        QCoreApplication::translate("main",
+                                                                    "Only generate the glyphs for "
+                                                                    "the characters in <string>. "
+                                                                    "By default all glyphs are "
+                                                                    "generated."),
+                                        QStringLiteral("string"));
+    parser.addOption(charactersOption);
+    QCommandLineOption textureSizeOption(QStringLiteral("texture-size"),
+                                         QCoreApplication::translate("main",
+                                                                     "Maximum texture size, "
+                                                                     "2048 by default."),
+                                         QStringLiteral("size"), QStringLiteral("2048"));
+    parser.addOption(textureSizeOption);
+    QCommandLineOption jobsOption({ QStringLiteral("j"), QStringLiteral("jobs") },
+                                  QCoreApplication::translate("main",
+                                                              "Number of threads to use, by "
+                                                              "default one per core."),
+                                  QStringLiteral("count"));
+    parser.addOption(jobsOption);
+    QCommandLineOption packingOrderOption(QStringLiteral("packing-order"),
+                                          QCoreApplication::translate("main",
+                                                                      "Order in which glyphs are "
+                                                                      "packed into textures: "
+                                                                      "'glyph', 'height' (default) "
+                                                                      "or 'range'."),
+                                          QStringLiteral("order"), QStringLiteral("height"));
+    parser.addOption(packingOrderOption);
+
+    // Fonts need a platform plugin, but the command line mode needs no display.
+    // The application type depends on the options, so parse them once before
+    // the application exists; process() below reports errors and handles
+    // --help and --version.
+    QStringList arguments;
+    arguments.reserve(argc);
+    for (int i = 0; i < argc; ++i)
+        arguments.append(QString::fromLocal8Bit(argv[i]));
+    parser.parse(arguments);
+    const bool headless = parser.isSet(outputOption);
+    if (headless && !qEnvironmentVariableIsSet("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QScopedPointer<QGuiApplication> app(headless ? new QGuiApplication(argc, argv)
+                                                 : new QApplication(argc, argv));
+    app->setOrganizationName(QStringLiteral("QtProject"));
+    app->setApplicationName(QStringLiteral("Qt Distance Field Generator"));
+    app->setApplicationVersion(QStringLiteral(QT_VERSION_STR));
+    parser.process(*app);
+
+    if (headless) {
+        if (parser.positionalArguments().size() != 1)
+            parser.showHelp(1);
+
+        bool ok = false;
+        const uint textureSize = parser.value(textureSizeOption).toUInt(&ok);
+        if (!ok || textureSize < 64) {
+            qWarning("%s", qPrintable(QCoreApplication::translate("main",
+                                                                  "Invalid texture size '%1'.")
+                                      .arg(parser.value(textureSizeOption))));
+            return 1;
+        }
+
+        int jobs = 0;
+        if (parser.isSet(jobsOption)) {
+            jobs = parser.value(jobsOption).toInt(&ok);
+            if (!ok || jobs < 1) {
+                qWarning("%s", qPrintable(QCoreApplication::translate("main",
+                                                                      "Invalid number of jobs '%1'.")
+                                          .arg(parser.value(jobsOption))));
+                return 1;
+            }
+        }
+
+        DistanceFieldFontWriter::PackingOrder packingOrder;
+        const QString order = parser.value(packingOrderOption);
+        if (order == QLatin1String("glyph")) {
+            packingOrder = DistanceFieldFontWriter::GivenOrder;
+        } else if (order == QLatin1String("height")) {
+            packingOrder = DistanceFieldFontWriter::HeightOrder;
+        } else if (order == QLatin1String("range")) {
+            packingOrder = DistanceFieldFontWriter::UnicodeRangeAndHeightOrder;
+        } else {
+            qWarning("%s", qPrintable(QCoreApplication::translate("main",
+                                                                  "Invalid packing order '%1'.")
+                                      .arg(order)));
+            return 1;
+        }
+
+        return generateFont(parser.positionalArguments().constFirst(),
+                            parser.value(outputOption),
+                            textureSize,
+                            parser.value(charactersOption),
+                            jobs,
+                            packingOrder);
+    }
 
     MainWindow mainWindow;
     if (!parser.positionalArguments().isEmpty())
         mainWindow.open(parser.positionalArguments().constFirst());
     mainWindow.show();
 
-    return app.exec();
+    return app->exec();
 }
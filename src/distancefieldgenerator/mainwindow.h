@@ -47,7 +47,6 @@ private slots:
 private:
     void setupConnections();
     void writeFile();
-    QByteArray createSfntTable();
 
     Ui::MainWindow *ui;
     QString m_fontDir;
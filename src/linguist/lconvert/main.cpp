@@ -9,6 +9,7 @@
 #include <QtCore/QStringList>
 #include <QtCore/QTranslator>
 #include <QtCore/QLibraryInfo>
+#include <QtCore/QThreadPool>
 
 #include <iostream>
 
@@ -91,6 +92,14 @@ struct File
     QString format;
 };
 
+struct Input
+{
+    Translator translator;
+    ConversionData cd;
+    Translator::Duplicates duplicates;
+    bool ok = false;
+};
+
 int main(int argc, char *argv[])
 {
     QCoreApplication app(argc, argv);
@@ -205,23 +214,44 @@ int main(int argc, char *argv[])
     if (inFiles.isEmpty())
         return usage(args);
 
-    tr.setLanguageCode(Translator::guessLanguageCodeFromFileName(inFiles[0].name));
-
-    if (!tr.load(inFiles[0].name, cd, inFiles[0].format)) {
-        std::cerr << qPrintable(cd.error());
-        return 2;
+    // The inputs are independent of each other, so they are loaded and
+    // their duplicates resolved in parallel. Everything that has visible
+    // effects is then done in the order of the inputs, as if they had been
+    // loaded one after the other.
+    QList<Input> inputs(inFiles.size());
+    inputs[0].translator.setLanguageCode(
+            Translator::guessLanguageCodeFromFileName(inFiles[0].name));
+    QThreadPool pool;
+    for (int i = 0; i < inFiles.size(); ++i) {
+        Input *input = &inputs[i];
+        input->cd = cd;
+        const File file = inFiles.at(i);
+        pool.start([input, file] {
+            input->ok = input->translator.load(file.name, input->cd, file.format);
+            if (input->ok)
+                input->duplicates = input->translator.resolveDuplicates();
+        });
     }
-    tr.reportDuplicates(tr.resolveDuplicates(), inFiles[0].name, verbose);
+    pool.waitForDone();
 
-    for (int i = 1; i < inFiles.size(); ++i) {
-        Translator tr2;
-        if (!tr2.load(inFiles[i].name, cd, inFiles[i].format)) {
+    for (int i = 0; i < inputs.size(); ++i) {
+        Input &input = inputs[i];
+        for (const QString &error : input.cd.errors())
+            cd.appendError(error);
+        if (!input.ok) {
             std::cerr << qPrintable(cd.error());
             return 2;
         }
-        tr2.reportDuplicates(tr2.resolveDuplicates(), inFiles[i].name, verbose);
-        for (int j = 0; j < tr2.messageCount(); ++j)
-            tr.replaceSorted(tr2.message(j));
+        cd.m_sourceDir = input.cd.m_sourceDir;
+        cd.m_sourceFileName = input.cd.m_sourceFileName;
+        input.translator.reportDuplicates(input.duplicates, inFiles[i].name, verbose);
+        if (i == 0) {
+            tr = std::move(input.translator);
+        } else {
+            for (int j = 0; j < input.translator.messageCount(); ++j)
+                tr.replaceSorted(input.translator.constMessage(j));
+            input.translator = Translator();
+        }
     }
 
     if (!targetLanguage.isEmpty())
@@ -54,12 +54,15 @@
 #include <QStackedWidget>
 #include <QStatusBar>
 #include <QTextStream>
+#include <QTimer>
 #include <QToolBar>
 #include <QUrl>
 #include <QWhatsThis>
 
 #include <ctype.h>
 
+#include <memory>
+
 QT_BEGIN_NAMESPACE
 
 static const int MessageMS = 2500;
@@ -144,6 +147,56 @@ static Ending ending(QString str, QLocale::Language lang)
 }
 
 
+struct ValidationOptions
+{
+    bool accelerators = false;
+    bool surroundingWhitespace = false;
+    bool endingPunctuation = false;
+    bool phraseMatches = false;
+    bool placeMarkerMatches = false;
+};
+
+struct ValidationModelData
+{
+    QLocale::Language sourceLanguage = QLocale::C;
+    QLocale::Language language = QLocale::C;
+    QList<bool> countRefNeeds;
+    // keyword -> friendly source and target text of the matching phrases
+    QHash<QString, QList<QPair<QString, QString> > > phrases;
+};
+
+struct ValidationError
+{
+    ErrorsView::ErrorType type;
+    QString arg;
+};
+
+struct ValidationItem
+{
+    MultiDataIndex index;
+    QString source;
+    MessageItem message;
+};
+
+struct ValidationJob
+{
+    ValidationOptions options;
+    QList<ValidationModelData> models;
+    QList<ValidationItem> items;
+};
+
+struct ValidationResult
+{
+    MultiDataIndex index;
+    QStringList translations;
+    bool danger;
+};
+
+static bool validateMessage(const MessageItem &m, const QString &source,
+                            const ValidationOptions &options, const ValidationModelData &data,
+                            QList<ValidationError> *errors);
+
+
 class ContextItemDelegate : public QItemDelegate
 {
 public:
@@ -483,6 +536,8 @@ MainWindow::MainWindow()
 
 MainWindow::~MainWindow()
 {
+    ++m_validationGeneration;
+    m_validationPool.waitForDone();
     writeConfig();
     if (m_assistantProcess && m_assistantProcess->state() == QProcess::Running) {
         m_assistantProcess->terminate();
@@ -504,6 +559,9 @@ void MainWindow::initViewHeaders()
 
 void MainWindow::modelCountChanged()
 {
+    // Pending validation results refer to the old set of models.
+    ++m_validationGeneration;
+
     int mc = m_dataModel->modelCount();
 
     for (int i = 0; i < mc; ++i) {
@@ -1542,7 +1600,9 @@ void MainWindow::updateTranslation(const QStringList &translations)
     if (translations == m->translations())
         return;
 
+    const MessageItem oldItem = *m;
     m->setTranslations(translations);
+    m_dataModel->model(m_currentIndex.model())->updateStatistics(oldItem, *m);
     if (!m->fileName().isEmpty() && hasFormPreview(m->fileName()))
         m_formPreviewView->setSourceContext(m_currentIndex.model(), m);
     updateDanger(m_currentIndex, true);
@@ -1778,8 +1838,69 @@ void MainWindow::findNext(const QString &text, DataModel::FindLocation where,
 
 void MainWindow::revalidate()
 {
-    for (MultiDataModelIterator it(m_dataModel, -1); it.isValid(); ++it)
-        updateDanger(it, false);
+    // Drop whatever a still running validation has not delivered yet.
+    const int generation = ++m_validationGeneration;
+
+    // Snapshot the messages on the GUI thread and check them on the
+    // validation pool. The danger flags are streamed back chunk by chunk.
+    auto job = std::make_shared<ValidationJob>();
+    job->options = validationOptions();
+    for (int mi = 0; mi < m_dataModel->modelCount(); ++mi) {
+        job->models.append(m_dataModel->isModelWritable(mi)
+                           ? validationData(mi, job->options.phraseMatches)
+                           : ValidationModelData());
+    }
+
+    for (MultiDataModelIterator it(m_dataModel, -1); it.isValid(); ++it) {
+        // The current message is checked verbosely below.
+        if (m_currentIndex.isValid() && it.context() == m_currentIndex.context()
+            && it.message() == m_currentIndex.message()) {
+            continue;
+        }
+        MultiDataIndex curIdx = it;
+        QString source;
+        for (int mi = 0; mi < m_dataModel->modelCount(); ++mi) {
+            if (!m_dataModel->isModelWritable(mi))
+                continue;
+            curIdx.setModel(mi);
+            MessageItem *m = m_dataModel->messageItem(curIdx);
+            if (!m || m->isObsolete())
+                continue;
+            if (!m->message().isTranslated()) {
+                if (m->danger())
+                    m_dataModel->setDanger(curIdx, false);
+                continue;
+            }
+            if (source.isEmpty()) {
+                source = m->pluralText();
+                if (source.isEmpty())
+                    source = m->text();
+            }
+            job->items.append({ curIdx, source, *m });
+        }
+    }
+
+    const qsizetype chunkSize = 1024;
+    for (qsizetype begin = 0; begin < job->items.size(); begin += chunkSize) {
+        const qsizetype end = qMin(begin + chunkSize, job->items.size());
+        m_validationPool.start([this, job, generation, begin, end] {
+            QList<ValidationResult> results;
+            for (qsizetype i = begin; i < end; ++i) {
+                if (m_validationGeneration != generation)
+                    return;
+                const ValidationItem &item = job->items.at(i);
+                const bool danger = validateMessage(item.message, item.source, job->options,
+                                                    job->models.at(item.index.model()), nullptr);
+                if (danger != item.message.danger())
+                    results.append({ item.index, item.message.translations(), danger });
+            }
+            if (!results.isEmpty()) {
+                QMetaObject::invokeMethod(this, [this, generation, results] {
+                    applyValidationResults(generation, results);
+                }, Qt::QueuedConnection);
+            }
+        });
+    }
 
     if (m_currentIndex.isValid())
         updateDanger(m_currentIndex, true);
@@ -2464,11 +2585,207 @@ static bool haveMnemonic(const QString &str)
     return false;
 }
 
+static bool validateMessage(const MessageItem &m, const QString &source,
+                            const ValidationOptions &options, const ValidationModelData &data,
+                            QList<ValidationError> *errors)
+{
+    bool danger = false;
+    QStringList translations = m.translations();
+
+    // Truncated variants are permitted to be "denormalized"
+    for (int i = 0; i < translations.count(); ++i) {
+        int sep = translations.at(i).indexOf(QChar(Translator::BinaryVariantSeparator));
+        if (sep >= 0)
+            translations[i].truncate(sep);
+    }
+
+    if (options.accelerators) {
+        bool sk = haveMnemonic(source);
+        bool tk = true;
+        for (int i = 0; i < translations.count() && tk; ++i) {
+            tk &= haveMnemonic(translations[i]);
+        }
+
+        if (!sk && tk) {
+            if (errors)
+                errors->append({ ErrorsView::SuperfluousAccelerator });
+            danger = true;
+        } else if (sk && !tk) {
+            if (errors)
+                errors->append({ ErrorsView::MissingAccelerator });
+            danger = true;
+        }
+    }
+    if (options.surroundingWhitespace) {
+        bool whitespaceok = true;
+        for (int i = 0; i < translations.count() && whitespaceok; ++i) {
+            whitespaceok &= (leadingWhitespace(source) == leadingWhitespace(translations[i]));
+            whitespaceok &= (trailingWhitespace(source) == trailingWhitespace(translations[i]));
+        }
+
+        if (!whitespaceok) {
+            if (errors)
+                errors->append({ ErrorsView::SurroundingWhitespaceDiffers });
+            danger = true;
+        }
+    }
+    if (options.endingPunctuation) {
+        bool endingok = true;
+        for (int i = 0; i < translations.count() && endingok; ++i) {
+            endingok &= (ending(source, data.sourceLanguage) ==
+                        ending(translations[i], data.language));
+        }
+
+        if (!endingok) {
+            if (errors)
+                errors->append({ ErrorsView::PunctuationDiffers });
+            danger = true;
+        }
+    }
+    if (options.phraseMatches) {
+        QString fsource = MainWindow::friendlyString(source);
+        QString ftranslation = MainWindow::friendlyString(translations.first());
+        QStringList lookupWords = fsource.split(QLatin1Char(' '));
+
+        bool phraseFound;
+        for (const QString &s : qAsConst(lookupWords)) {
+            if (data.phrases.contains(s)) {
+                phraseFound = true;
+                const auto phrases = data.phrases.value(s);
+                for (const auto &p : phrases) {
+                    if (fsource == p.first) {
+                        if (ftranslation.indexOf(p.second) >= 0) {
+                            phraseFound = true;
+                            break;
+                        } else {
+                            phraseFound = false;
+                        }
+                    }
+                }
+                if (!phraseFound) {
+                    if (errors)
+                        errors->append({ ErrorsView::IgnoredPhrasebook, s });
+                    danger = true;
+                }
+            }
+        }
+    }
+
+    if (options.placeMarkerMatches) {
+        // Stores the occurrence count of the place markers in the map placeMarkerIndexes.
+        // i.e. the occurrence count of %1 is stored at placeMarkerIndexes[1],
+        // count of %2 is stored at placeMarkerIndexes[2] etc.
+        // In the first pass, it counts all place markers in the sourcetext.
+        // In the second pass it (de)counts all place markers in the translation.
+        // When finished, all elements should have returned to a count of 0,
+        // if not there is a mismatch
+        // between place markers in the source text and the translation text.
+        QHash<int, int> placeMarkerIndexes;
+        QString translation;
+        int numTranslations = translations.count();
+        for (int pass = 0; pass < numTranslations + 1; ++pass) {
+            const QChar *uc_begin = source.unicode();
+            const QChar *uc_end = uc_begin + source.length();
+            if (pass >= 1) {
+                translation = translations[pass - 1];
+                uc_begin = translation.unicode();
+                uc_end = uc_begin + translation.length();
+            }
+            const QChar *c = uc_begin;
+            while (c < uc_end) {
+                if (c->unicode() == '%') {
+                    const QChar *escape_start = ++c;
+                    while (c->isDigit())
+                        ++c;
+                    const QChar *escape_end = c;
+                    bool ok = true;
+                    int markerIndex = QString::fromRawData(
+                            escape_start, escape_end - escape_start).toInt(&ok);
+                    if (ok)
+                        placeMarkerIndexes[markerIndex] += (pass == 0 ? numTranslations : -1);
+                }
+                ++c;
+            }
+        }
+
+        for (int i : qAsConst(placeMarkerIndexes)) {
+            if (i != 0) {
+                if (errors)
+                    errors->append({ ErrorsView::PlaceMarkersDiffer });
+                danger = true;
+                break;
+            }
+        }
+
+        // Piggy-backed on the general place markers, we check the plural count marker.
+        if (m.message().isPlural()) {
+            for (int i = 0; i < numTranslations; ++i)
+                if (data.countRefNeeds.at(i)
+                    && !(translations[i].contains(QLatin1String("%n"))
+                    || translations[i].contains(QLatin1String("%Ln")))) {
+                    if (errors)
+                        errors->append({ ErrorsView::NumerusMarkerMissing });
+                    danger = true;
+                    break;
+                }
+        }
+    }
+    return danger;
+}
+
+ValidationOptions MainWindow::validationOptions() const
+{
+    ValidationOptions options;
+    options.accelerators = m_ui.actionAccelerators->isChecked();
+    options.surroundingWhitespace = m_ui.actionSurroundingWhitespace->isChecked();
+    options.endingPunctuation = m_ui.actionEndingPunctuation->isChecked();
+    options.phraseMatches = m_ui.actionPhraseMatches->isChecked();
+    options.placeMarkerMatches = m_ui.actionPlaceMarkerMatches->isChecked();
+    return options;
+}
+
+/*
+  Copies what validateMessage() needs to know about \a model, so that the
+  checks can run without touching the data model or the phrase books.
+  If \a source is not null, only the phrases that can match it are copied.
+*/
+ValidationModelData MainWindow::validationData(int model, bool withPhrases,
+                                               const QString &source) const
+{
+    ValidationModelData data;
+    data.sourceLanguage = m_dataModel->sourceLanguage(model);
+    data.language = m_dataModel->language(model);
+    data.countRefNeeds = m_dataModel->model(model)->countRefNeeds();
+    if (!withPhrases)
+        return data;
+
+    const QHash<QString, QList<Phrase *> > &pd = m_phraseDict.at(model);
+    auto addPhrases = [&](const QString &keyword, const QList<Phrase *> &phrases) {
+        QList<QPair<QString, QString> > &texts = data.phrases[keyword];
+        texts.reserve(phrases.size());
+        for (const Phrase *p : phrases)
+            texts.append(qMakePair(friendlyString(p->source()), friendlyString(p->target())));
+    };
+    if (source.isNull()) {
+        for (auto it = pd.cbegin(), end = pd.cend(); it != end; ++it)
+            addPhrases(it.key(), it.value());
+    } else {
+        const QStringList lookupWords = friendlyString(source).split(QLatin1Char(' '));
+        for (const QString &s : lookupWords) {
+            const auto it = pd.constFind(s);
+            if (it != pd.cend() && !data.phrases.contains(s))
+                addPhrases(s, it.value());
+        }
+    }
+    return data;
+}
+
 void MainWindow::updateDanger(const MultiDataIndex &index, bool verbose)
 {
     MultiDataIndex curIdx = index;
     m_errorsView->clear();
 
+    const ValidationOptions options = validationOptions();
     QString source;
     for (int mi = 0; mi < m_dataModel->modelCount(); ++mi) {
         if (!m_dataModel->isModelWritable(mi))
@@ -2485,146 +2802,12 @@ void MainWindow::updateDanger(const MultiDataIndex &index, bool verbose)
                 if (source.isEmpty())
                     source = m->text();
             }
-            QStringList translations = m->translations();
-
-            // Truncated variants are permitted to be "denormalized"
-            for (int i = 0; i < translations.count(); ++i) {
-                int sep = translations.at(i).indexOf(QChar(Translator::BinaryVariantSeparator));
-                if (sep >= 0)
-                    translations[i].truncate(sep);
-            }
-
-            if (m_ui.actionAccelerators->isChecked()) {
-                bool sk = haveMnemonic(source);
-                bool tk = true;
-                for (int i = 0; i < translations.count() && tk; ++i) {
-                    tk &= haveMnemonic(translations[i]);
-                }
-
-                if (!sk && tk) {
-                    if (verbose)
-                        m_errorsView->addError(mi, ErrorsView::SuperfluousAccelerator);
-                    danger = true;
-                } else if (sk && !tk) {
-                    if (verbose)
-                        m_errorsView->addError(mi, ErrorsView::MissingAccelerator);
-                    danger = true;
-                }
-            }
-            if (m_ui.actionSurroundingWhitespace->isChecked()) {
-                bool whitespaceok = true;
-                for (int i = 0; i < translations.count() && whitespaceok; ++i) {
-                    whitespaceok &= (leadingWhitespace(source) == leadingWhitespace(translations[i]));
-                    whitespaceok &= (trailingWhitespace(source) == trailingWhitespace(translations[i]));
-                }
-
-                if (!whitespaceok) {
-                    if (verbose)
-                        m_errorsView->addError(mi, ErrorsView::SurroundingWhitespaceDiffers);
-                    danger = true;
-                }
-            }
-            if (m_ui.actionEndingPunctuation->isChecked()) {
-                bool endingok = true;
-                for (int i = 0; i < translations.count() && endingok; ++i) {
-                    endingok &= (ending(source, m_dataModel->sourceLanguage(mi)) ==
-                                ending(translations[i], m_dataModel->language(mi)));
-                }
-
-                if (!endingok) {
-                    if (verbose)
-                        m_errorsView->addError(mi, ErrorsView::PunctuationDiffers);
-                    danger = true;
-                }
-            }
-            if (m_ui.actionPhraseMatches->isChecked()) {
-                QString fsource = friendlyString(source);
-                QString ftranslation = friendlyString(translations.first());
-                QStringList lookupWords = fsource.split(QLatin1Char(' '));
-
-                bool phraseFound;
-                for (const QString &s : qAsConst(lookupWords)) {
-                    if (m_phraseDict[mi].contains(s)) {
-                        phraseFound = true;
-                        const auto phrases = m_phraseDict[mi].value(s);
-                        for (const Phrase *p : phrases) {
-                            if (fsource == friendlyString(p->source())) {
-                                if (ftranslation.indexOf(friendlyString(p->target())) >= 0) {
-                                    phraseFound = true;
-                                    break;
-                                } else {
-                                    phraseFound = false;
-                                }
-                            }
-                        }
-                        if (!phraseFound) {
-                            if (verbose)
-                                m_errorsView->addError(mi, ErrorsView::IgnoredPhrasebook, s);
-                            danger = true;
-                        }
-                    }
-                }
-            }
-
-            if (m_ui.actionPlaceMarkerMatches->isChecked()) {
-                // Stores the occurrence count of the place markers in the map placeMarkerIndexes.
-                // i.e. the occurrence count of %1 is stored at placeMarkerIndexes[1],
-                // count of %2 is stored at placeMarkerIndexes[2] etc.
-                // In the first pass, it counts all place markers in the sourcetext.
-                // In the second pass it (de)counts all place markers in the translation.
-                // When finished, all elements should have returned to a count of 0,
-                // if not there is a mismatch
-                // between place markers in the source text and the translation text.
-                QHash<int, int> placeMarkerIndexes;
-                QString translation;
-                int numTranslations = translations.count();
-                for (int pass = 0; pass < numTranslations + 1; ++pass) {
-                    const QChar *uc_begin = source.unicode();
-                    const QChar *uc_end = uc_begin + source.length();
-                    if (pass >= 1) {
-                        translation = translations[pass - 1];
-                        uc_begin = translation.unicode();
-                        uc_end = uc_begin + translation.length();
-                    }
-                    const QChar *c = uc_begin;
-                    while (c < uc_end) {
-                        if (c->unicode() == '%') {
-                            const QChar *escape_start = ++c;
-                            while (c->isDigit())
-                                ++c;
-                            const QChar *escape_end = c;
-                            bool ok = true;
-                            int markerIndex = QString::fromRawData(
-                                    escape_start, escape_end - escape_start).toInt(&ok);
-                            if (ok)
-                                placeMarkerIndexes[markerIndex] += (pass == 0 ? numTranslations : -1);
-                        }
-                        ++c;
-                    }
-                }
-
-                for (int i : qAsConst(placeMarkerIndexes)) {
-                    if (i != 0) {
-                        if (verbose)
-                            m_errorsView->addError(mi, ErrorsView::PlaceMarkersDiffer);
-                        danger = true;
-                        break;
-                    }
-                }
-
-                // Piggy-backed on the general place markers, we check the plural count marker.
-                if (m->message().isPlural()) {
-                    for (int i = 0; i < numTranslations; ++i)
-                        if (m_dataModel->model(mi)->countRefNeeds().at(i)
-                            && !(translations[i].contains(QLatin1String("%n"))
-                            || translations[i].contains(QLatin1String("%Ln")))) {
-                            if (verbose)
-                                m_errorsView->addError(mi, ErrorsView::NumerusMarkerMissing);
-                            danger = true;
-                            break;
-                        }
-                }
-            }
+            QList<ValidationError> errors;
+            danger = validateMessage(*m, source, options,
+                                     validationData(mi, options.phraseMatches, source),
+                                     verbose ? &errors : nullptr);
+            for (const ValidationError &error : qAsConst(errors))
+                m_errorsView->addError(mi, error.type, error.arg);
         }
 
         if (danger != m->danger())
@@ -2635,6 +2818,21 @@ void MainWindow::updateDanger(const MultiDataIndex &index, bool verbose)
         statusBar()->showMessage(m_errorsView->firstError());
 }
 
+void MainWindow::applyValidationResults(int generation, const QList<ValidationResult> &results)
+{
+    if (generation != m_validationGeneration)
+        return;
+
+    for (const ValidationResult &result : results) {
+        MessageItem *m = m_dataModel->messageItem(result.index);
+        // Skip messages that were edited after the job took its snapshot.
+        if (!m || m->isObsolete() || m->translations() != result.translations)
+            continue;
+        if (m->danger() != result.danger)
+            m_dataModel->setDanger(result.index, result.danger);
+    }
+}
+
 void MainWindow::readConfig()
 {
     QSettings config;
@@ -2753,14 +2951,20 @@ void MainWindow::toggleVisualizeWhitespace()
 
 void MainWindow::maybeUpdateStatistics(const MultiDataIndex &index)
 {
-    if (index.model() == m_currentIndex.model())
+    if (index.model() != m_currentIndex.model() || m_statisticsUpdatePending)
+        return;
+
+    // Coalesce the bursts of changes from batch operations and revalidation.
+    m_statisticsUpdatePending = true;
+    QTimer::singleShot(0, this, [this] {
+        m_statisticsUpdatePending = false;
         updateStatistics();
+    });
 }
 
 void MainWindow::updateStatistics()
 {
     // don't call this if stats dialog is not open
-    // because this can be slow...
     if (!m_statistics || !m_statistics->isVisible() || m_currentIndex.model() < 0)
         return;
 
@@ -13,9 +13,12 @@
 #include <QtCore/QHash>
 #include <QtCore/QMap>
 #include <QtCore/QLocale>
+#include <QtCore/QThreadPool>
 
 #include <QtWidgets/QMainWindow>
 
+#include <atomic>
+
 QT_BEGIN_NAMESPACE
 
 class QPixmap;
@@ -41,6 +44,9 @@ class SourceCodeView;
 class Statistics;
 class TranslateDialog;
 class TranslationSettingsDialog;
+struct ValidationModelData;
+struct ValidationOptions;
+struct ValidationResult;
 
 class MainWindow : public QMainWindow
 {
@@ -175,6 +181,10 @@ private:
 
     // FIXME: move to DataModel
     void updateDanger(const MultiDataIndex &index, bool verbose);
+    ValidationOptions validationOptions() const;
+    ValidationModelData validationData(int model, bool withPhrases,
+                                       const QString &source = QString()) const;
+    void applyValidationResults(int generation, const QList<ValidationResult> &results);
 
     bool searchItem(DataModel::FindLocation where, const QString &searchWhat);
 
@@ -229,6 +239,11 @@ private:
 
     Ui::MainWindow m_ui;    // menus and actions
     Statistics *m_statistics;
+    bool m_statisticsUpdatePending = false;
+
+    // Bumped to cancel a running revalidate() job
+    std::atomic<int> m_validationGeneration = 0;
+    QThreadPool m_validationPool;
 };
 
 QT_END_NAMESPACE
@@ -90,9 +90,7 @@ DataModel::DataModel(QObject *parent)
   : QObject(parent),
     m_modified(false),
     m_numMessages(0),
-    m_srcWords(0),
-    m_srcChars(0),
-    m_srcCharsSpc(0),
+    m_statistics(),
     m_language(QLocale::Language(-1)),
     m_sourceLanguage(QLocale::Language(-1)),
     m_country(QLocale::Country(-1)),
@@ -212,9 +210,7 @@ bool DataModel::load(const QString &fileName, bool *langGuessed, QWidget *parent
 
     QHash<QString, int> contexts;
 
-    m_srcWords = 0;
-    m_srcChars = 0;
-    m_srcCharsSpc = 0;
+    m_statistics = StatisticalData();
 
     for (const TranslatorMessage &msg : tor.messages()) {
         if (!contexts.contains(msg.context())) {
@@ -230,10 +226,13 @@ bool DataModel::load(const QString &fileName, bool *langGuessed, QWidget *parent
             if (msg.type() == TranslatorMessage::Finished)
                 c->incrementFinishedCount();
             if (msg.type() == TranslatorMessage::Finished || msg.type() == TranslatorMessage::Unfinished) {
-                doCharCounting(tmp.text(), m_srcWords, m_srcChars, m_srcCharsSpc);
-                doCharCounting(tmp.pluralText(), m_srcWords, m_srcChars, m_srcCharsSpc);
+                doCharCounting(tmp.text(), m_statistics.wordsSource, m_statistics.charsSource,
+                               m_statistics.charsSpacesSource);
+                doCharCounting(tmp.pluralText(), m_statistics.wordsSource, m_statistics.charsSource,
+                               m_statistics.charsSpacesSource);
                 c->incrementNonobsoleteCount();
             }
+            countMessage(tmp, 1);
             c->appendMessage(tmp);
             ++m_numMessages;
         }
@@ -400,39 +399,50 @@ void DataModel::setSourceLanguageAndCountry(QLocale::Language lang, QLocale::Cou
     setModified(true);
 }
 
-void DataModel::updateStatistics()
+void DataModel::countMessage(const MessageItem &mi, int sign)
 {
-    StatisticalData stats {};
-    for (DataModelIterator it(this); it.isValid(); ++it) {
-        const MessageItem *mi = it.current();
-        if (mi->isObsolete()) {
-            stats.obsoleteMsg++;
-        } else if (mi->isFinished()) {
-            bool hasDanger = false;
-            for (const QString &trnsl : mi->translations()) {
-                doCharCounting(trnsl, stats.wordsFinished, stats.charsFinished, stats.charsSpacesFinished);
-                hasDanger |= mi->danger();
-            }
-            if (hasDanger)
-                stats.translatedMsgDanger++;
-            else
-                stats.translatedMsgNoDanger++;
-        } else if (mi->isUnfinished()) {
-            bool hasDanger = false;
-            for (const QString &trnsl : mi->translations()) {
-                doCharCounting(trnsl, stats.wordsUnfinished, stats.charsUnfinished, stats.charsSpacesUnfinished);
-                hasDanger |= mi->danger();
-            }
-            if (hasDanger)
-                stats.unfinishedMsgDanger++;
-            else
-                stats.unfinishedMsgNoDanger++;
-        }
+    if (mi.isObsolete()) {
+        m_statistics.obsoleteMsg += sign;
+        return;
+    }
+    if (!mi.isFinished() && !mi.isUnfinished())
+        return;
+
+    int words = 0;
+    int chars = 0;
+    int charsSpaces = 0;
+    const QStringList translations = mi.translations();
+    for (const QString &trnsl : translations)
+        doCharCounting(trnsl, words, chars, charsSpaces);
+    const bool hasDanger = mi.danger() && !translations.isEmpty();
+    if (mi.isFinished()) {
+        m_statistics.wordsFinished += sign * words;
+        m_statistics.charsFinished += sign * chars;
+        m_statistics.charsSpacesFinished += sign * charsSpaces;
+        if (hasDanger)
+            m_statistics.translatedMsgDanger += sign;
+        else
+            m_statistics.translatedMsgNoDanger += sign;
+    } else {
+        m_statistics.wordsUnfinished += sign * words;
+        m_statistics.charsUnfinished += sign * chars;
+        m_statistics.charsSpacesUnfinished += sign * charsSpaces;
+        if (hasDanger)
+            m_statistics.unfinishedMsgDanger += sign;
+        else
+            m_statistics.unfinishedMsgNoDanger += sign;
     }
-    stats.wordsSource = m_srcWords;
-    stats.charsSource = m_srcChars;
-    stats.charsSpacesSource = m_srcCharsSpc;
-    emit statsChanged(stats);
+}
+
+void DataModel::updateStatistics(const MessageItem &oldItem, const MessageItem &newItem)
+{
+    countMessage(oldItem, -1);
+    countMessage(newItem, 1);
+}
+
+void DataModel::updateStatistics()
+{
+    emit statsChanged(m_statistics);
 }
 
 void DataModel::setModified(bool isModified)
@@ -980,7 +990,9 @@ void MultiDataModel::setTranslation(const MultiDataIndex &index, const QString &
     MessageItem *m = messageItem(index);
     if (translation == m->translation())
         return;
+    const MessageItem oldItem = *m;
     m->setTranslation(translation);
+    m_dataModels[index.model()]->updateStatistics(oldItem, *m);
     setModified(index.model(), true);
     emit translationChanged(index);
 }
@@ -992,8 +1004,10 @@ void MultiDataModel::setFinished(const MultiDataIndex &index, bool finished)
     ContextItem *c = contextItem(index);
     MessageItem *m = messageItem(index);
     TranslatorMessage::Type type = m->type();
+    const MessageItem oldItem = *m;
     if (type == TranslatorMessage::Unfinished && finished) {
         m->setType(TranslatorMessage::Finished);
+        m_dataModels[index.model()]->updateStatistics(oldItem, *m);
         mm->decrementUnfinishedCount();
         if (!mm->countUnfinished()) {
             incrementFinishedCount();
@@ -1014,6 +1028,7 @@ void MultiDataModel::setFinished(const MultiDataIndex &index, bool finished)
         setModified(index.model(), true);
     } else if (type == TranslatorMessage::Finished && !finished) {
         m->setType(TranslatorMessage::Unfinished);
+        m_dataModels[index.model()]->updateStatistics(oldItem, *m);
         mm->incrementUnfinishedCount();
         if (mm->countUnfinished() == 1) {
             decrementFinishedCount();
@@ -1039,7 +1054,13 @@ void MultiDataModel::setDanger(const MultiDataIndex &index, bool danger)
 {
     ContextItem *c = contextItem(index);
     MessageItem *m = messageItem(index);
-    if (!m->danger() && danger) {
+    if (m->danger() == danger)
+        return;
+
+    const MessageItem oldItem = *m;
+    m->setDanger(danger);
+    m_dataModels[index.model()]->updateStatistics(oldItem, *m);
+    if (danger) {
         if (m->isFinished()) {
             c->incrementFinishedDangerCount();
             if (c->finishedDangerCount() == 1)
@@ -1049,9 +1070,7 @@ void MultiDataModel::setDanger(const MultiDataIndex &index, bool danger)
             if (c->unfinishedDangerCount() == 1)
                 emit contextDataChanged(index);
         }
-        emit messageDataChanged(index);
-        m->setDanger(danger);
-    } else if (m->danger() && !danger) {
+    } else {
         if (m->isFinished()) {
             c->decrementFinishedDangerCount();
             if (!c->finishedDangerCount())
@@ -1061,9 +1080,8 @@ void MultiDataModel::setDanger(const MultiDataIndex &index, bool danger)
             if (!c->unfinishedDangerCount())
                 emit contextDataChanged(index);
         }
-        emit messageDataChanged(index);
-        m->setDanger(danger);
     }
+    emit messageDataChanged(index);
 }
 
 void MultiDataModel::updateCountsOnAdd(int model, bool writable)
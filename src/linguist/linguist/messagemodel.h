@@ -17,7 +17,24 @@ QT_BEGIN_NAMESPACE
 
 class DataModel;
 class MultiDataModel;
-struct StatisticalData;
+
+struct StatisticalData
+{
+    int wordsSource;
+    int charsSource;
+    int charsSpacesSource;
+    int wordsFinished;
+    int charsFinished;
+    int charsSpacesFinished;
+    int wordsUnfinished;
+    int charsUnfinished;
+    int charsSpacesUnfinished;
+    int translatedMsgNoDanger;
+    int translatedMsgDanger;
+    int obsoleteMsg;
+    int unfinishedMsgNoDanger;
+    int unfinishedMsgDanger;
+};
 
 class MessageItem
 {
@@ -188,10 +205,12 @@ public:
     QStringList normalizedTranslations(const MessageItem &m) const;
     void doCharCounting(const QString& text, int& trW, int& trC, int& trCS);
     void updateStatistics();
+    // Call with the state of a message before and after changing it
+    void updateStatistics(const MessageItem &oldItem, const MessageItem &newItem);
 
-    int getSrcWords() const { return m_srcWords; }
-    int getSrcChars() const { return m_srcChars; }
-    int getSrcCharsSpc() const { return m_srcCharsSpc; }
+    int getSrcWords() const { return m_statistics.wordsSource; }
+    int getSrcChars() const { return m_statistics.charsSource; }
+    int getSrcCharsSpc() const { return m_statistics.charsSpacesSource; }
 
 signals:
     void statsChanged(const StatisticalData &newStats);
@@ -205,16 +224,15 @@ private:
 
     bool save(const QString &fileName, QWidget *parent);
     void updateLocale();
+    void countMessage(const MessageItem &mi, int sign);
 
     bool m_writable;
     bool m_modified;
 
     int m_numMessages;
 
-    // For statistics
-    int m_srcWords;
-    int m_srcChars;
-    int m_srcCharsSpc;
+    // Kept up to date incrementally as messages change
+    StatisticalData m_statistics;
 
     QString m_srcFileName;
     QLocale::Language m_language;
@@ -4,29 +4,12 @@
 #ifndef STATISTICS_H
 #define STATISTICS_H
 
+#include "messagemodel.h"
 #include "ui_statistics.h"
 #include <QVariant>
 
 QT_BEGIN_NAMESPACE
 
-struct StatisticalData
-{
-    int wordsSource;
-    int charsSource;
-    int charsSpacesSource;
-    int wordsFinished;
-    int charsFinished;
-    int charsSpacesFinished;
-    int wordsUnfinished;
-    int charsUnfinished;
-    int charsSpacesUnfinished;
-    int translatedMsgNoDanger;
-    int translatedMsgDanger;
-    int obsoleteMsg;
-    int unfinishedMsgNoDanger;
-    int unfinishedMsgDanger;
-};
-
 class Statistics : public QDialog, public Ui::Statistics
 {
     Q_OBJECT
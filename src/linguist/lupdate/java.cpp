@@ -8,7 +8,6 @@
 #include <QtCore/QDebug>
 #include <QtCore/QFile>
 #include <QtCore/QStack>
-#include <QtCore/QStack>
 #include <QtCore/QString>
 #include <QtCore/QCoreApplication>
 #include <QtCore/QStringConverter>
@@ -44,39 +43,71 @@ class Scope
         {}
 };
 
-/*
-  The tokenizer maintains the following global variables. The names
-  should be self-explanatory.
-*/
-
-static QString yyFileName;
-static QChar yyCh;
-static QString yyIdent;
-static QString yyComment;
-static QString yyString;
-static bool yyEOF = false;
-
-static qlonglong yyInteger;
-static int yyParenDepth;
-static int yyLineNo;
-static int yyCurLineNo;
-static int yyParenLineNo;
-static int yyTok;
-
-// the string to read from and current position in the string
-static QString yyInStr;
-static int yyInPos;
-
-// The parser maintains the following global variables.
-static QString yyPackage;
-static QStack<Scope*> yyScope;
-
-std::ostream &yyMsg(int line = 0)
+class JavaParser
+{
+public:
+    JavaParser(const QString &fileName, const QString &in);
+    ~JavaParser();
+
+    void parse(Translator *tor, ConversionData &cd);
+
+private:
+    std::ostream &yyMsg(int line = 0);
+
+    QChar getChar();
+    int getToken();
+
+    bool match(int t);
+    bool matchString(QString &s);
+    bool matchStringOrNull(QString &s);
+    bool matchExpression();
+    QString context() const;
+
+    void recordMessage(
+        Translator *tor, const QString &context, const QString &text, const QString &comment,
+        const QString &extracomment, bool plural, ConversionData &cd);
+
+    // Tokenizer state
+    QString yyFileName;
+    QChar yyCh;
+    QString yyIdent;
+    QString yyComment;
+    QString yyString;
+    bool yyEOF = false;
+
+    qlonglong yyInteger = 0;
+    int yyParenDepth = 0;
+    int yyLineNo = 0;
+    int yyCurLineNo = 1;
+    int yyParenLineNo = 1;
+    int yyTok = -1;
+
+    // the string to read from and current position in the string
+    QString yyInStr;
+    int yyInPos = 0;
+
+    // Parser state
+    QString yyPackage;
+    QStack<Scope*> yyScope;
+};
+
+JavaParser::JavaParser(const QString &fileName, const QString &in)
+    : yyFileName(fileName),
+      yyInStr(in)
+{
+}
+
+JavaParser::~JavaParser()
+{
+    qDeleteAll(yyScope);
+}
+
+std::ostream &JavaParser::yyMsg(int line)
 {
-    return std::cerr << qPrintable(yyFileName) << ':' << (line ? line : yyLineNo) << ": ";
+    return lupdateDiagnostics() << qPrintable(yyFileName) << ':' << (line ? line : yyLineNo) << ": ";
 }
 
-static QChar getChar()
+QChar JavaParser::getChar()
 {
     if (yyInPos >= yyInStr.size()) {
         yyEOF = true;
@@ -88,7 +119,7 @@ static QChar getChar()
     return c;
 }
 
-static int getToken()
+int JavaParser::getToken()
 {
     const char tab[] = "bfnrt\"\'\\";
     const char backTab[] = "\b\f\n\r\t\"\'\\";
@@ -308,7 +339,7 @@ static int getToken()
     return Tok_Eof;
 }
 
-static bool match( int t )
+bool JavaParser::match( int t )
 {
     bool matches = ( yyTok == t );
     if ( matches )
@@ -316,7 +347,7 @@ static bool match( int t )
     return matches;
 }
 
-static bool matchString( QString &s )
+bool JavaParser::matchString( QString &s )
 {
     if ( yyTok != Tok_String )
         return false;
@@ -338,7 +369,7 @@ static bool matchString( QString &s )
     return true;
 }
 
-static bool matchStringOrNull(QString &s)
+bool JavaParser::matchStringOrNull(QString &s)
 {
     bool matches = matchString(s);
     if (!matches) {
@@ -363,7 +394,7 @@ static bool matchStringOrNull(QString &s)
  * list(a,b).size(2,4)
  * etc...
  */
-static bool matchExpression()
+bool JavaParser::matchExpression()
 {
     if (match(Tok_Integer)) {
         return true;
@@ -391,7 +422,7 @@ static bool matchExpression()
     return true;
 }
 
-static const QString context()
+QString JavaParser::context() const
 {
       QString context(yyPackage);
       bool innerClass = false;
@@ -409,7 +440,7 @@ static const QString context()
      return context;
 }
 
-static void recordMessage(
+void JavaParser::recordMessage(
     Translator *tor, const QString &context, const QString &text, const QString &comment,
     const QString &extracomment, bool plural, ConversionData &cd)
 {
@@ -421,7 +452,7 @@ static void recordMessage(
     tor->extend(msg, cd);
 }
 
-static void parse(Translator *tor, ConversionData &cd)
+void JavaParser::parse(Translator *tor, ConversionData &cd)
 {
     QString text;
     QString com;
@@ -567,25 +598,12 @@ bool loadJava(Translator &translator, const QString &filename, ConversionData &c
         return false;
     }
 
-    yyInPos = -1;
-    yyFileName = filename;
-    yyPackage.clear();
-    yyScope.clear();
-    yyTok = -1;
-    yyParenDepth = 0;
-    yyCurLineNo = 0;
-    yyParenLineNo = 1;
-
     QTextStream ts(&file);
     ts.setEncoding(cd.m_sourceIsUtf16 ? QStringConverter::Utf16 : QStringConverter::Utf8);
     ts.setAutoDetectUnicode(true);
-    yyInStr = ts.readAll();
-    yyInPos = 0;
-    yyFileName = filename;
-    yyCurLineNo = 1;
-    yyParenLineNo = 1;
 
-    parse(&translator, cd);
+    JavaParser parser(filename, ts.readAll());
+    parser.parse(&translator, cd);
     return true;
 }
 
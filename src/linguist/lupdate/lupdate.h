@@ -14,6 +14,8 @@
 #include <QtCore/QStringList>
 #include <QtCore/QTranslator>
 
+#include <iosfwd>
+
 QT_BEGIN_NAMESPACE
 
 class ConversionData;
@@ -83,6 +85,21 @@ public:
     static QString transcode(const QString &str);
 };
 
+// Stream the per-file extractors write their warnings to. This is
+// std::cerr, unless a DiagnosticsCapture is active on the current thread.
+std::ostream &lupdateDiagnostics();
+
+class DiagnosticsCapture
+{
+public:
+    explicit DiagnosticsCapture(std::ostream *stream);
+    ~DiagnosticsCapture();
+
+private:
+    Q_DISABLE_COPY(DiagnosticsCapture)
+    std::ostream *m_previous;
+};
+
 class TrFunctionAliasManager {
 public:
     TrFunctionAliasManager();
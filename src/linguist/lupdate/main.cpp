@@ -20,9 +20,12 @@
 #include <QtCore/QLibraryInfo>
 #include <QtCore/QString>
 #include <QtCore/QStringList>
+#include <QtCore/QThreadPool>
 #include <QtCore/QTranslator>
 
 #include <iostream>
+#include <sstream>
+#include <vector>
 
 using namespace Qt::StringLiterals;
 
@@ -187,6 +190,24 @@ QString ParserTool::transcode(const QString &str)
     return QString::fromUtf8(out.constData(), out.length());
 }
 
+static thread_local std::ostream *diagnosticsStream = nullptr;
+
+std::ostream &lupdateDiagnostics()
+{
+    return diagnosticsStream ? *diagnosticsStream : std::cerr;
+}
+
+DiagnosticsCapture::DiagnosticsCapture(std::ostream *stream)
+    : m_previous(diagnosticsStream)
+{
+    diagnosticsStream = stream;
+}
+
+DiagnosticsCapture::~DiagnosticsCapture()
+{
+    diagnosticsStream = m_previous;
+}
+
 static QString m_defaultExtensions;
 
 static void printOut(const QString & out)
@@ -495,35 +516,142 @@ static bool processTs(Translator &fetchedTor, const QString &file, ConversionDat
     return false;
 }
 
+namespace {
+
+using SourceLoader = bool (*)(Translator &, const QString &, ConversionData &);
+
+struct ExtractedFile
+{
+    Translator translator;
+    ConversionData cd;
+    std::string diagnostics;
+    bool setsExtras = false;
+};
+
+} // unnamed namespace
+
+static SourceLoader sourceLoader(const QString &sourceFile)
+{
+    if (sourceFile.endsWith(QLatin1String(".java"), Qt::CaseInsensitive))
+        return loadJava;
+    if (sourceFile.endsWith(QLatin1String(".ui"), Qt::CaseInsensitive)
+        || sourceFile.endsWith(QLatin1String(".jui"), Qt::CaseInsensitive))
+        return loadUI;
+#ifndef QT_NO_QML
+    if (sourceFile.endsWith(QLatin1String(".js"), Qt::CaseInsensitive)
+        || sourceFile.endsWith(QLatin1String(".qs"), Qt::CaseInsensitive))
+        return loadQScript;
+    if (sourceFile.endsWith(QLatin1String(".qml"), Qt::CaseInsensitive))
+        return loadQml;
+#endif // QT_NO_QML
+    if (sourceFile.endsWith(u".py", Qt::CaseInsensitive))
+        return loadPython;
+    return nullptr;
+}
+
+static void extractFile(SourceLoader loader, const QString &sourceFile, ExtractedFile *result)
+{
+    // Loaders only call setExtras() when they find a context comment. Magic
+    // comment keys never contain spaces, so this marker only survives if the
+    // loader left the extras alone.
+    static const TranslatorMessage::ExtraData unsetExtras = {
+        { QStringLiteral("lupdate unset extras"), QString() }
+    };
+    result->translator.setExtras(unsetExtras);
+    std::ostringstream diagnostics;
+    {
+        DiagnosticsCapture capture(&diagnostics);
+        loader(result->translator, sourceFile, result->cd);
+    }
+    result->diagnostics = diagnostics.str();
+    result->setsExtras = result->translator.extras() != unsetExtras;
+}
+
+/*
+  Replays the messages a loader extracted into its own translator onto
+  \a fetchedTor, occurrence by occurrence, so that the result does not
+  depend on whether the file was parsed on its own or straight into
+  \a fetchedTor.
+*/
+static void mergeExtracted(Translator &fetchedTor, const ExtractedFile &file,
+                           bool appendsContextComments, ConversionData &cd)
+{
+    const Translator &fileTor = file.translator;
+    for (const TranslatorMessage &msg : fileTor.messages()) {
+        if (appendsContextComments && msg.sourceText().isEmpty()) {
+            fetchedTor.append(msg);
+            continue;
+        }
+        TranslatorMessage occurrence = msg;
+        occurrence.setReferences({ TranslatorMessage::Reference(msg.fileName(),
+                                                                msg.lineNumber()) });
+        fetchedTor.extend(occurrence, cd);
+        occurrence.setExtraComment(QString());
+        for (const TranslatorMessage::Reference &ref : msg.extraReferences()) {
+            occurrence.setFileName(ref.fileName());
+            occurrence.setLineNumber(ref.lineNumber());
+            fetchedTor.extend(occurrence, cd);
+        }
+    }
+    if (file.setsExtras)
+        fetchedTor.setExtras(fileTor.extras());
+}
+
 static void processSources(Translator &fetchedTor,
                            const QStringList &sourceFiles, ConversionData &cd, bool *fail)
 {
 #ifdef QT_NO_QML
     bool requireQmlSupport = false;
 #endif
-    QStringList sourceFilesCpp;
+    QList<SourceLoader> loaders;
+    loaders.reserve(sourceFiles.size());
     for (const auto &sourceFile : sourceFiles) {
-        if (sourceFile.endsWith(QLatin1String(".java"), Qt::CaseInsensitive))
-            loadJava(fetchedTor, sourceFile, cd);
-        else if (sourceFile.endsWith(QLatin1String(".ui"), Qt::CaseInsensitive)
-                 || sourceFile.endsWith(QLatin1String(".jui"), Qt::CaseInsensitive))
-            loadUI(fetchedTor, sourceFile, cd);
-#ifndef QT_NO_QML
-        else if (sourceFile.endsWith(QLatin1String(".js"), Qt::CaseInsensitive)
-                 || sourceFile.endsWith(QLatin1String(".qs"), Qt::CaseInsensitive))
-            loadQScript(fetchedTor, sourceFile, cd);
-        else if (sourceFile.endsWith(QLatin1String(".qml"), Qt::CaseInsensitive))
-            loadQml(fetchedTor, sourceFile, cd);
-#else
-        else if (sourceFile.endsWith(QLatin1String(".qml"), Qt::CaseInsensitive)
-                 || sourceFile.endsWith(QLatin1String(".js"), Qt::CaseInsensitive)
-                 || sourceFile.endsWith(QLatin1String(".qs"), Qt::CaseInsensitive))
+        loaders.append(sourceLoader(sourceFile));
+#ifdef QT_NO_QML
+        if (sourceFile.endsWith(QLatin1String(".qml"), Qt::CaseInsensitive)
+            || sourceFile.endsWith(QLatin1String(".js"), Qt::CaseInsensitive)
+            || sourceFile.endsWith(QLatin1String(".qs"), Qt::CaseInsensitive))
             requireQmlSupport = true;
 #endif // QT_NO_QML
-        else if (sourceFile.endsWith(u".py", Qt::CaseInsensitive))
-            loadPython(fetchedTor, sourceFile, cd);
-        else if (!processTs(fetchedTor, sourceFile, cd))
+    }
+
+    // The QML/JS, Python, Java and UI extractors keep all their state in
+    // per-file parser objects, so run them concurrently. Each file is
+    // extracted into its own translator and merged below in input order,
+    // which keeps the generated TS files deterministic.
+    std::vector<ExtractedFile> extracted(sourceFiles.size());
+    ConversionData fileCd = cd;
+    fileCd.clearErrors();
+    trFunctionAliasManager.nameToTrFunctionMap(); // build the lazy alias hash up front
+    {
+        QThreadPool pool;
+        for (qsizetype i = 0; i < sourceFiles.size(); ++i) {
+            if (!loaders.at(i))
+                continue;
+            extracted[i].cd = fileCd;
+            pool.start([&, i] { extractFile(loaders.at(i), sourceFiles.at(i), &extracted[i]); });
+        }
+        pool.waitForDone();
+    }
+
+    QStringList sourceFilesCpp;
+    for (qsizetype i = 0; i < sourceFiles.size(); ++i) {
+        const QString &sourceFile = sourceFiles.at(i);
+        if (const SourceLoader loader = loaders.at(i)) {
+            ExtractedFile &file = extracted[i];
+            std::cerr << file.diagnostics;
+#ifndef QT_NO_QML
+            const bool appendsContextComments = loader == loadQml || loader == loadQScript;
+#else
+            const bool appendsContextComments = false;
+#endif
+            mergeExtracted(fetchedTor, file, appendsContextComments, cd);
+            for (const QString &error : file.cd.errors())
+                cd.appendError(error);
+            file = ExtractedFile();
+        } else if (!processTs(fetchedTor, sourceFile, cd)) {
             sourceFilesCpp << sourceFile;
+        }
     }
 
 #ifdef QT_NO_QML
@@ -14,6 +14,8 @@
 #include <cerrno>
 #include <cstdio>
 #include <cstring>
+#include <memory>
+#include <ostream>
 
 QT_BEGIN_NAMESPACE
 
@@ -30,55 +32,120 @@ enum Token { Tok_Eof, Tok_class, Tok_return, Tok_tr,
              Tok_LeftParen, Tok_RightParen,
              Tok_Comma, Tok_None, Tok_Integer};
 
-/*
-  The tokenizer maintains the following global variables. The names
-  should be self-explanatory.
-*/
-static QString yyFileName;
-static int yyCh;
-static QByteArray yyIdent;
-static char yyComment[65536];
-static size_t yyCommentLen;
-static char yyString[65536];
-static size_t yyStringLen;
-static int yyParenDepth;
-static int yyLineNo;
-static int yyCurLineNo;
-
-static QByteArray extraComment;
-static QByteArray id;
-
-QHash<QByteArray, Token> tokens = {
-    {"None", Tok_None},
-    {"class", Tok_class},
-    {"return", Tok_return},
-    {"__tr", Tok_tr}, // Legacy?
-    {"__trUtf8", Tok_trUtf8}
-};
-
-// the file to read from (if reading from a file)
-static FILE *yyInFile;
-
-// the string to read from and current position in the string (otherwise)
-static int yyInPos;
-static int buf;
-
-static int (*getChar)();
-static int (*peekChar)();
-
-static int yyIndentationSize;
-static int yyContinuousSpaceCount;
-static bool yyCountingIndentation;
-
 // (Context, indentation level) pair.
 using ContextPair = QPair<QByteArray, int>;
 // Stack of (Context, indentation level) pairs.
 using ContextStack = QStack<ContextPair>;
-static ContextStack yyContextStack;
 
-static int yyContextPops;
+class PythonParser
+{
+public:
+    PythonParser(const QString &fileName, FILE *inFile);
+
+    void parse(Translator &tor, ConversionData &cd,
+               const QByteArray &initialContext = {},
+               const QByteArray &defaultContext = {});
+
+private:
+    std::ostream &yyMsg(int line = 0);
+
+    int getChar();
+    int peekChar();
+
+    Token parseString();
+    QByteArray readLine();
+    Token getToken();
+
+    bool match(Token t);
+    bool matchString(QByteArray *s);
+    bool matchEncoding(bool *utf8);
+    bool matchStringOrNone(QByteArray *s);
+    bool matchExpression();
+    bool parseTranslate(QByteArray *text, QByteArray *context, QByteArray *comment,
+                        bool *utf8, bool *plural);
+    void setMessageParameters(TranslatorMessage *message);
+
+    // Tokenizer state
+    QString yyFileName;
+    int yyCh = 0;
+    QByteArray yyIdent;
+    char yyComment[65536];
+    size_t yyCommentLen = 0;
+    char yyString[65536];
+    size_t yyStringLen = 0;
+    int yyParenDepth = 0;
+    int yyLineNo = 0;
+    int yyCurLineNo = 1;
+
+    QByteArray extraComment;
+    QByteArray id;
+
+    // the file to read from
+    FILE *yyInFile;
+    int buf = -1;
+
+    int yyIndentationSize = 1;
+    int yyContinuousSpaceCount = 0;
+    bool yyCountingIndentation = false;
+
+    ContextStack yyContextStack;
+
+    int yyContextPops = 0;
+
+    // Parser state
+    Token yyTok = Tok_Eof;
+};
+
+static const QHash<QByteArray, Token> &tokenTable()
+{
+    // Match the function aliases to our tokens. The aliases are fixed by
+    // the time the first file is parsed, so the table is built only once.
+    static const QHash<QByteArray, Token> tokens = [] {
+        QHash<QByteArray, Token> result = {
+            {"None", Tok_None},
+            {"class", Tok_class},
+            {"return", Tok_return},
+            {"__tr", Tok_tr}, // Legacy?
+            {"__trUtf8", Tok_trUtf8}
+        };
+        const auto &nameMap  = trFunctionAliasManager.nameToTrFunctionMap();
+        for (auto it = nameMap.cbegin(), end = nameMap.cend(); it != end; ++it) {
+            switch (it.value()) {
+            case TrFunctionAliasManager::Function_tr:
+            case TrFunctionAliasManager::Function_QT_TR_NOOP:
+                result.insert(it.key().toUtf8(), Tok_tr);
+                break;
+            case TrFunctionAliasManager::Function_trUtf8:
+                result.insert(it.key().toUtf8(), Tok_trUtf8);
+                break;
+            case TrFunctionAliasManager::Function_translate:
+            case TrFunctionAliasManager::Function_QT_TRANSLATE_NOOP:
+            // QTranslator::findMessage() has the same parameters as QApplication::translate().
+            case TrFunctionAliasManager::Function_findMessage:
+                result.insert(it.key().toUtf8(), Tok_translate);
+                break;
+            default:
+                break;
+            }
+        }
+        return result;
+    }();
+    return tokens;
+}
 
-static int getCharFromFile()
+PythonParser::PythonParser(const QString &fileName, FILE *inFile)
+    : yyFileName(fileName),
+      yyInFile(inFile)
+{
+    yyCh = getChar();
+}
+
+std::ostream &PythonParser::yyMsg(int line)
+{
+    return lupdateDiagnostics() << qPrintable(yyFileName) << ':' << (line ? line : yyLineNo) << ": ";
+}
+
+int PythonParser::getChar()
 {
     int c;
 
@@ -111,34 +178,14 @@ static int getCharFromFile()
     return c;
 }
 
-static int peekCharFromFile()
+int PythonParser::peekChar()
 {
     int c = getc(yyInFile);
     buf = c;
     return c;
 }
 
-static void startTokenizer(const QString &fileName, int (*getCharFunc)(),
-                           int (*peekCharFunc)())
-{
-    yyInPos = 0;
-    buf = -1;
-    getChar = getCharFunc;
-    peekChar = peekCharFunc;
-
-    yyFileName = fileName;
-    yyCh = getChar();
-    yyParenDepth = 0;
-    yyCurLineNo = 1;
-
-    yyIndentationSize = 1;
-    yyContinuousSpaceCount = 0;
-    yyCountingIndentation = false;
-    yyContextStack.clear();
-    yyContextPops = 0;
-}
-
-static Token parseString()
+Token PythonParser::parseString()
 {
     static const char tab[] = "abfnrtv";
     static const char backTab[] = "\a\b\f\n\r\t\v";
@@ -240,8 +287,7 @@ static Token parseString()
     if (yyCh != quoteChar) {
         printf("%c\n", yyCh);
 
-        qWarning("%s:%d: Unterminated string",
-                 qPrintable(yyFileName), yyLineNo);
+        yyMsg() << "Unterminated string\n";
     }
 
     if (yyCh == EOF)
@@ -250,7 +296,7 @@ static Token parseString()
     return Tok_String;
 }
 
-static QByteArray readLine()
+QByteArray PythonParser::readLine()
 {
     QByteArray result;
     while (true) {
@@ -262,7 +308,7 @@ static QByteArray readLine()
     return result;
 }
 
-static Token getToken()
+Token PythonParser::getToken()
 {
     yyIdent.clear();
     yyCommentLen = 0;
@@ -276,7 +322,7 @@ static Token getToken()
                 yyCh = getChar();
             } while (std::isalnum(yyCh) || yyCh == '_');
 
-            return tokens.value(yyIdent, Tok_Ident);
+            return tokenTable().value(yyIdent, Tok_Ident);
         }
         switch (yyCh) {
         case '#':
@@ -361,9 +407,7 @@ static Token getToken()
   (3) the call appears within a function defined outside the class definition.
 */
 
-static Token yyTok;
-
-static bool match(Token t)
+bool PythonParser::match(Token t)
 {
     const bool matches = (yyTok == t);
     if (matches)
@@ -371,7 +415,7 @@ static bool match(Token t)
     return matches;
 }
 
-static bool matchString(QByteArray *s)
+bool PythonParser::matchString(QByteArray *s)
 {
     const bool matches = (yyTok == Tok_String);
     s->clear();
@@ -382,7 +426,7 @@ static bool matchString(QByteArray *s)
     return matches;
 }
 
-static bool matchEncoding(bool *utf8)
+bool PythonParser::matchEncoding(bool *utf8)
 {
     // Remove any leading module paths.
     if (yyTok == Tok_Ident && std::strcmp(yyIdent, "PySide6") == 0) {
@@ -421,7 +465,7 @@ static bool matchEncoding(bool *utf8)
     return false;
 }
 
-static bool matchStringOrNone(QByteArray *s)
+bool PythonParser::matchStringOrNone(QByteArray *s)
 {
     bool matches = matchString(s);
 
@@ -444,7 +488,7 @@ static bool matchStringOrNone(QByteArray *s)
  * list(a,b).size(2,4)
  * etc...
  */
-static bool matchExpression()
+bool PythonParser::matchExpression()
 {
     if (match(Tok_Integer))
         return true;
@@ -472,8 +516,8 @@ static bool matchExpression()
     return true;
 }
 
-static bool parseTranslate(QByteArray *text, QByteArray *context, QByteArray *comment,
-                           bool *utf8, bool *plural)
+bool PythonParser::parseTranslate(QByteArray *text, QByteArray *context, QByteArray *comment,
+                                  bool *utf8, bool *plural)
 {
     text->clear();
     context->clear();
@@ -543,7 +587,7 @@ static bool parseTranslate(QByteArray *text, QByteArray *context, QByteArray *co
     return false;
 }
 
-static inline void setMessageParameters(TranslatorMessage *message)
+void PythonParser::setMessageParameters(TranslatorMessage *message)
 {
     if (!extraComment.isEmpty()) {
         message->setExtraComment(QString::fromUtf8(extraComment));
@@ -555,9 +599,9 @@ static inline void setMessageParameters(TranslatorMessage *message)
     }
 }
 
-static void parse(Translator &tor, ConversionData &cd,
-                  const QByteArray &initialContext = {},
-                  const QByteArray &defaultContext = {})
+void PythonParser::parse(Translator &tor, ConversionData &cd,
+                         const QByteArray &initialContext,
+                         const QByteArray &defaultContext)
 {
     QByteArray context;
     QByteArray text;
@@ -670,55 +714,33 @@ static void parse(Translator &tor, ConversionData &cd,
     }
 
     if (yyParenDepth != 0) {
-        qWarning("%s: Unbalanced parentheses in Python code",
-                 qPrintable(yyFileName));
+        lupdateDiagnostics() << qPrintable(yyFileName)
+                             << ": Unbalanced parentheses in Python code\n";
     }
 }
 
 bool loadPython(Translator &translator, const QString &fileName, ConversionData &cd)
 {
-    // Match the function aliases to our tokens
-    static bool firstTime = true;
-    if (firstTime) {
-        firstTime = false;
-        const auto &nameMap  = trFunctionAliasManager.nameToTrFunctionMap();
-        for (auto it = nameMap.cbegin(), end = nameMap.cend(); it != end; ++it) {
-            switch (it.value()) {
-            case TrFunctionAliasManager::Function_tr:
-            case TrFunctionAliasManager::Function_QT_TR_NOOP:
-                tokens.insert(it.key().toUtf8(), Tok_tr);
-                break;
-            case TrFunctionAliasManager::Function_trUtf8:
-                tokens.insert(it.key().toUtf8(), Tok_trUtf8);
-                break;
-            case TrFunctionAliasManager::Function_translate:
-            case TrFunctionAliasManager::Function_QT_TRANSLATE_NOOP:
-            // QTranslator::findMessage() has the same parameters as QApplication::translate().
-            case TrFunctionAliasManager::Function_findMessage:
-                tokens.insert(it.key().toUtf8(), Tok_translate);
-                break;
-            default:
-                break;
-            }
-        }
-    }
-
+    FILE *inFile = nullptr;
 #ifdef Q_CC_MSVC
     const auto *fileNameC = reinterpret_cast<const wchar_t *>(fileName.utf16());
-    const bool ok = _wfopen_s(&yyInFile, fileNameC, L"r") == 0;
+    const bool ok = _wfopen_s(&inFile, fileNameC, L"r") == 0;
 #else
     const QByteArray fileNameC = QFile::encodeName(fileName);
-    yyInFile = std::fopen( fileNameC.constData(), "r");
-    const bool ok = yyInFile != nullptr;
+    inFile = std::fopen( fileNameC.constData(), "r");
+    const bool ok = inFile != nullptr;
 #endif
     if (!ok) {
         cd.appendError(QStringLiteral("Cannot open %1").arg(fileName));
         return false;
     }
 
-    startTokenizer(fileName, getCharFromFile, peekCharFromFile);
-    parse(translator, cd);
-    std::fclose(yyInFile);
+    {
+        // The tokenizer buffers are too large for the stack of a worker thread.
+        auto parser = std::make_unique<PythonParser>(fileName, inFile);
+        parser->parse(translator, cd);
+    }
+    std::fclose(inFile);
     return true;
 }
 
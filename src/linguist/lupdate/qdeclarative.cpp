@@ -198,13 +198,13 @@ protected:
 private:
     std::ostream &yyMsg(int line)
     {
-        return std::cerr << qPrintable(m_fileName) << ':' << line << ": ";
+        return lupdateDiagnostics() << qPrintable(m_fileName) << ':' << line << ": ";
     }
 
     void throwRecursionDepthError() final
     {
-        std::cerr << qPrintable(m_fileName) << ": "
-                  << "Maximum statement or expression depth exceeded";
+        lupdateDiagnostics() << qPrintable(m_fileName) << ": "
+                             << "Maximum statement or expression depth exceeded";
     }
 
 
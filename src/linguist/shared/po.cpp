@@ -21,14 +21,45 @@ QT_BEGIN_NAMESPACE
 
 static const int MAX_LEN = 79;
 
+static inline bool needsPoEscape(char16_t c)
+{
+    return c < 32 || c == '"' || c == '\\';
+}
+
+// Returns the position of the next character that needs escaping, or \a len.
+// Plain text is skipped in branch-free blocks, so that the loop vectorizes.
+static qsizetype findPoEscape(const char16_t *s, qsizetype from, qsizetype len)
+{
+    constexpr qsizetype BlockSize = 16;
+    qsizetype i = from;
+    while (i + BlockSize <= len) {
+        bool found = false;
+        for (qsizetype j = i; j < i + BlockSize; ++j)
+            found |= needsPoEscape(s[j]);
+        if (found)
+            break;
+        i += BlockSize;
+    }
+    while (i < len && !needsPoEscape(s[i]))
+        ++i;
+    return i;
+}
+
 static QString poEscapedString(const QString &prefix, const QString &keyword,
                                bool noWrap, const QString &ba)
 {
+    const char16_t *s = reinterpret_cast<const char16_t *>(ba.constData());
+    const qsizetype len = ba.length();
     QStringList lines;
-    int off = 0;
+    qsizetype off = 0;
     QString res;
-    while (off < ba.length()) {
-        ushort c = ba[off++].unicode();
+    while (off < len) {
+        const qsizetype end = findPoEscape(s, off, len);
+        res.append(ba.constData() + off, end - off);
+        if (end == len)
+            break;
+        off = end + 1;
+        ushort c = s[end];
         switch (c) {
         case '\n':
             res += QLatin1String("\\n");
@@ -60,14 +91,10 @@ static QString poEscapedString(const QString &prefix, const QString &keyword,
             res += QLatin1String("\\\\");
             break;
         default:
-            if (c < 32) {
-                res += QLatin1String("\\x");
-                res += QString::number(c, 16);
-                if (off < ba.length() && isxdigit(ba[off].unicode()))
-                    res += QLatin1String("\"\"");
-            } else {
-                res += QChar(c);
-            }
+            res += QLatin1String("\\x");
+            res += QString::number(c, 16);
+            if (off < len && isxdigit(s[off]))
+                res += QLatin1String("\"\"");
             break;
         }
     }
@@ -12,8 +12,12 @@
 #include <QtCore/QFile>
 #include <QtCore/QFileInfo>
 #include <QtCore/QMap>
+#include <QtCore/QScopeGuard>
 #include <QtCore/QString>
 #include <QtCore/QStringDecoder>
+#include <QtCore/QtEndian>
+
+#include <limits>
 
 QT_BEGIN_NAMESPACE
 
@@ -432,11 +436,35 @@ static void fromBytes(const char *str, int len, QString *out, bool *utf8Fail)
     *utf8Fail = toUnicode.hasError();
 }
 
+static bool formatError(ConversionData &cd)
+{
+    cd.appendError(QLatin1String("QM-Format error"));
+    return false;
+}
+
 bool loadQM(Translator &translator, QIODevice &dev, ConversionData &cd)
 {
-    QByteArray ba = dev.readAll();
-    const uchar *data = (uchar*)ba.data();
-    int len = ba.size();
+    // Files are mapped instead of being copied into memory. Everything
+    // read from the messages is checked against the bounds of its block,
+    // as reading past the mapping would crash.
+    QByteArray ba;
+    const uchar *data = nullptr;
+    int len = 0;
+    QFileDevice *file = qobject_cast<QFileDevice *>(&dev);
+    if (file && !file->isSequential() && file->pos() == 0
+            && file->size() > 0 && file->size() <= std::numeric_limits<int>::max()) {
+        len = int(file->size());
+        data = file->map(0, len);
+    }
+    const auto unmap = qScopeGuard([file, data] {
+        if (data)
+            file->unmap(const_cast<uchar *>(data));
+    });
+    if (!data) {
+        ba = dev.readAll();
+        data = (uchar*)ba.data();
+        len = ba.size();
+    }
     if (len < MagicLength || memcmp(data, magic, MagicLength) != 0) {
         cd.appendError(QLatin1String("QM-Format error: magic marker missing"));
         return false;
@@ -446,6 +474,7 @@ bool loadQM(Translator &translator, QIODevice &dev, ConversionData &cd)
 
     // for squeezed but non-file data, this is what needs to be deleted
     const uchar *messageArray = nullptr;
+    uint messageLength = 0;
     const uchar *offsetArray = nullptr;
     uint offsetLength = 0;
 
@@ -473,6 +502,7 @@ bool loadQM(Translator &translator, QIODevice &dev, ConversionData &cd)
             //qDebug() << "HASHES: " << blockLen << QByteArray((const char *)data, blockLen).toHex();
         } else if (tag == Messages) {
             messageArray = data;
+            messageLength = blockLen;
             //qDebug() << "MESSAGES: " << blockLen << QByteArray((const char *)data, blockLen).toHex();
         } else if (tag == Dependencies) {
             QStringList dependencies;
@@ -508,38 +538,40 @@ bool loadQM(Translator &translator, QIODevice &dev, ConversionData &cd)
     QString context, sourcetext, comment;
     QStringList translations;
 
+    const uchar *messageEnd = messageArray + messageLength;
     for (const uchar *start = offsetArray; start != offsetArray + (numItems << 3); start += 8) {
         //quint32 hash = read32(start);
         quint32 ro = read32(start + 4);
         //qDebug() << "\nHASH:" << hash;
+        if (ro >= messageLength)
+            return formatError(cd);
         const uchar *m = messageArray + ro;
 
         for (;;) {
+            if (m >= messageEnd)
+                return formatError(cd);
             uchar tag = read8(m++);
             //qDebug() << "Tag:" << tag << " ADDR: " << m;
             switch(tag) {
             case Tag_End:
                 goto end;
             case Tag_Translation: {
+                if (messageEnd - m < 4)
+                    return formatError(cd);
                 int len = read32(m);
                 m += 4;
 
                 // -1 indicates an empty string
                 // Otherwise streaming format is UTF-16 -> 2 bytes per character
-                if ((len != -1) && (len & 1)) {
-                    cd.appendError(QLatin1String("QM-Format error"));
-                    return false;
-                }
+                if ((len != -1) && ((len & 1) || len < 0 || messageEnd - m < len))
+                    return formatError(cd);
                 QString str;
-                if (len != -1)
-                    str = QString((const QChar *)m, len / 2);
-                if (QSysInfo::ByteOrder == QSysInfo::LittleEndian) {
-                    for (int i = 0; i < str.length(); ++i)
-                        str[i] = QChar((str.at(i).unicode() >> 8) +
-                            ((str.at(i).unicode() << 8) & 0xff00));
+                if (len != -1) {
+                    str = QString(len / 2, Qt::Uninitialized);
+                    qFromBigEndian<char16_t>(m, len / 2, str.data());
+                    m += len;
                 }
                 translations << str;
-                m += len;
                 break;
             }
             case Tag_Obsolete1:
@@ -547,8 +579,12 @@ bool loadQM(Translator &translator, QIODevice &dev, ConversionData &cd)
                 //qDebug() << "OBSOLETE";
                 break;
             case Tag_SourceText: {
+                if (messageEnd - m < 4)
+                    return formatError(cd);
                 quint32 len = read32(m);
                 m += 4;
+                if (quint32(messageEnd - m) < len)
+                    return formatError(cd);
                 //qDebug() << "SOURCE LEN: " << len;
                 //qDebug() << "SOURCE: " << QByteArray((const char*)m, len);
                 fromBytes((const char*)m, len, &sourcetext, &utf8Fail);
@@ -556,8 +592,12 @@ bool loadQM(Translator &translator, QIODevice &dev, ConversionData &cd)
                 break;
             }
             case Tag_Context: {
+                if (messageEnd - m < 4)
+                    return formatError(cd);
                 quint32 len = read32(m);
                 m += 4;
+                if (quint32(messageEnd - m) < len)
+                    return formatError(cd);
                 //qDebug() << "CONTEXT LEN: " << len;
                 //qDebug() << "CONTEXT: " << QByteArray((const char*)m, len);
                 fromBytes((const char*)m, len, &context, &utf8Fail);
@@ -565,8 +605,12 @@ bool loadQM(Translator &translator, QIODevice &dev, ConversionData &cd)
                 break;
             }
             case Tag_Comment: {
+                if (messageEnd - m < 4)
+                    return formatError(cd);
                 quint32 len = read32(m);
                 m += 4;
+                if (quint32(messageEnd - m) < len)
+                    return formatError(cd);
                 //qDebug() << "COMMENT LEN: " << len;
                 //qDebug() << "COMMENT: " << QByteArray((const char*)m, len);
                 fromBytes((const char*)m, len, &comment, &utf8Fail);
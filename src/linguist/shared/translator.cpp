@@ -22,13 +22,17 @@
 #include <QtCore/QRegularExpression>
 #include <QtCore/QTextStream>
 
+#include <algorithm>
+
 #include <private/qtranslator_p.h>
 
 QT_BEGIN_NAMESPACE
 
 Translator::Translator() :
     m_locationsType(AbsoluteLocations),
-    m_indexOk(true)
+    m_indexOk(true),
+    m_locationIndexOk(false),
+    m_referenceIndexOk(false)
 {
 }
 
@@ -50,14 +54,218 @@ QList<Translator::FileFormat> &Translator::registeredFileFormats()
     return theFormats;
 }
 
+void TMOrder::insert(int pos, int idx)
+{
+    if (m_nodes.isEmpty()) {
+        if (pos == idx)
+            return;
+        for (int i = 0; i < idx; ++i)
+            add(i, i);
+    }
+    add(pos, idx);
+}
+
+void TMOrder::add(int pos, int idx)
+{
+    // Any well mixed number does as the priority. This one keeps the tree reproducible.
+    uint priority = uint(idx);
+    priority = (priority ^ (priority >> 16)) * 0x85ebca6bU;
+    priority = (priority ^ (priority >> 13)) * 0xc2b2ae35U;
+    priority ^= priority >> 16;
+    m_nodes.append(Node{ -1, -1, -1, 1, priority });
+    if (m_root < 0) {
+        m_root = idx;
+        return;
+    }
+    int node = m_root;
+    for (;;) {
+        Node &n = m_nodes[node];
+        ++n.size;
+        const int leftSize = size(n.left);
+        if (pos <= leftSize) {
+            if (n.left < 0) {
+                n.left = idx;
+                break;
+            }
+            node = n.left;
+        } else {
+            pos -= leftSize + 1;
+            if (n.right < 0) {
+                n.right = idx;
+                break;
+            }
+            node = n.right;
+        }
+    }
+    m_nodes[idx].parent = node;
+    while (m_nodes.at(idx).parent >= 0
+           && m_nodes.at(m_nodes.at(idx).parent).priority < m_nodes.at(idx).priority) {
+        rotateUp(idx);
+    }
+}
+
+void TMOrder::rotateUp(int node)
+{
+    Node &n = m_nodes[node];
+    const int parent = n.parent;
+    Node &p = m_nodes[parent];
+    const int grandParent = p.parent;
+    if (p.left == node) {
+        p.left = n.right;
+        if (n.right >= 0)
+            m_nodes[n.right].parent = parent;
+        n.right = parent;
+    } else {
+        p.right = n.left;
+        if (n.left >= 0)
+            m_nodes[n.left].parent = parent;
+        n.left = parent;
+    }
+    p.parent = node;
+    n.parent = grandParent;
+    if (grandParent < 0)
+        m_root = node;
+    else if (m_nodes.at(grandParent).left == parent)
+        m_nodes[grandParent].left = node;
+    else
+        m_nodes[grandParent].right = node;
+    p.size = 1 + size(p.left) + size(p.right);
+    n.size = 1 + size(n.left) + size(n.right);
+}
+
+int TMOrder::nodeAt(int pos) const
+{
+    int node = m_root;
+    for (;;) {
+        const Node &n = m_nodes.at(node);
+        const int leftSize = size(n.left);
+        if (pos == leftSize)
+            return node;
+        if (pos < leftSize) {
+            node = n.left;
+        } else {
+            pos -= leftSize + 1;
+            node = n.right;
+        }
+    }
+}
+
+int TMOrder::positionOf(int idx) const
+{
+    int pos = size(m_nodes.at(idx).left);
+    for (int node = idx, parent; (parent = m_nodes.at(node).parent) >= 0; node = parent) {
+        if (m_nodes.at(parent).right == node)
+            pos += size(m_nodes.at(parent).left) + 1;
+    }
+    return pos;
+}
+
+QList<int> TMOrder::toList() const
+{
+    QList<int> order;
+    order.reserve(m_nodes.size());
+    QList<int> stack;
+    for (int node = m_root; node >= 0 || !stack.isEmpty(); ) {
+        if (node >= 0) {
+            stack.append(node);
+            node = m_nodes.at(node).left;
+        } else {
+            node = stack.takeLast();
+            order.append(node);
+            node = m_nodes.at(node).right;
+        }
+    }
+    return order;
+}
+
+// Like a full rebuild of the index, lets the last one of several equal messages win
+template <typename Key>
+static void setIndex(QHash<Key, int> &index, const Key &key, int idx, const TMOrder &order)
+{
+    auto it = index.find(key);
+    if (it == index.end())
+        index.insert(key, idx);
+    else if (order.indexOf(*it) <= order.indexOf(idx))
+        *it = idx;
+}
+
+template <typename Key>
+static void addPosition(QHash<Key, QList<int>> &index, const Key &key, int idx,
+                        const TMOrder &order)
+{
+    QList<int> &indexes = index[key];
+    auto it = std::lower_bound(indexes.begin(), indexes.end(), order.indexOf(idx),
+                               [&order](int i, int pos) { return order.indexOf(i) < pos; });
+    if (it == indexes.end() || *it != idx)
+        indexes.insert(it, idx);
+}
+
+template <typename Key>
+static void removePosition(QHash<Key, QList<int>> &index, const Key &key, int idx,
+                           const TMOrder &order)
+{
+    auto it = index.find(key);
+    if (it == index.end())
+        return;
+    QList<int> &indexes = it.value();
+    auto iit = std::lower_bound(indexes.begin(), indexes.end(), order.indexOf(idx),
+                                [&order](int i, int pos) { return order.indexOf(i) < pos; });
+    if (iit != indexes.end() && *iit == idx)
+        indexes.erase(iit);
+    if (indexes.isEmpty())
+        index.erase(it);
+}
+
+template <typename Key>
+static void renumber(QHash<Key, int> &index, const QList<int> &newIndexes)
+{
+    for (int &idx : index)
+        idx = newIndexes.at(idx);
+}
+
+template <typename Key>
+static void renumber(QHash<Key, QList<int>> &index, const QList<int> &newIndexes)
+{
+    for (QList<int> &indexes : index) {
+        for (int &idx : indexes)
+            idx = newIndexes.at(idx);
+    }
+}
+
+// Moves the messages to their actual positions in m_messages
+void Translator::sortMessages() const
+{
+    if (m_order.isEmpty())
+        return;
+    const QList<int> order = m_order.toList();
+    QList<int> newIndexes(order.size());
+    TMM messages;
+    messages.reserve(order.size());
+    for (int idx : order) {
+        newIndexes[idx] = messages.size();
+        messages.append(std::move(m_messages[idx]));
+    }
+    m_messages = std::move(messages);
+    m_order.clear();
+    if (m_indexOk) {
+        renumber(m_ctxCmtIdx, newIndexes);
+        renumber(m_idMsgIdx, newIndexes);
+        renumber(m_msgIdx, newIndexes);
+    }
+    if (m_locationIndexOk)
+        renumber(m_locationIdx, newIndexes);
+    if (m_referenceIndexOk)
+        renumber(m_referenceIdx, newIndexes);
+}
+
 void Translator::addIndex(int idx, const TranslatorMessage &msg) const
 {
     if (msg.sourceText().isEmpty() && msg.id().isEmpty()) {
-        m_ctxCmtIdx[msg.context()] = idx;
+        setIndex(m_ctxCmtIdx, msg.context(), idx, m_order);
     } else {
-        m_msgIdx[TMMKey(msg)] = idx;
+        setIndex(m_msgIdx, TMMKey(msg), idx, m_order);
         if (!msg.id().isEmpty())
-            m_idMsgIdx[msg.id()] = idx;
+            setIndex(m_idMsgIdx, msg.id(), idx, m_order);
     }
 }
 
@@ -80,20 +288,77 @@ void Translator::ensureIndexed() const
         m_ctxCmtIdx.clear();
         m_idMsgIdx.clear();
         m_msgIdx.clear();
-        for (int i = 0; i < m_messages.count(); i++)
-            addIndex(i, m_messages.at(i));
+        for (int i = 0; i < m_messages.count(); i++) {
+            const int idx = m_order.at(i);
+            addIndex(idx, m_messages.at(idx));
+        }
+    }
+}
+
+// Maintains the indexes of the messages by their locations, if they are in use
+void Translator::addLocationIndex(int idx, const TranslatorMessage &msg) const
+{
+    if (m_locationIndexOk)
+        addPosition(m_locationIdx, LocationKey(msg.fileName(), msg.context()), idx, m_order);
+    if (m_referenceIndexOk) {
+        for (const TranslatorMessage::Reference &ref : msg.allReferences())
+            addPosition(m_referenceIdx, TMRKey(msg.context(), msg.comment(), ref), idx, m_order);
+    }
+}
+
+void Translator::delLocationIndex(int idx) const
+{
+    const TranslatorMessage &msg = m_messages.at(idx);
+    if (m_locationIndexOk)
+        removePosition(m_locationIdx, LocationKey(msg.fileName(), msg.context()), idx, m_order);
+    if (m_referenceIndexOk) {
+        for (const TranslatorMessage::Reference &ref : msg.allReferences())
+            removePosition(m_referenceIdx, TMRKey(msg.context(), msg.comment(), ref), idx,
+                           m_order);
+    }
+}
+
+void Translator::ensureLocationIndexed() const
+{
+    if (!m_locationIndexOk) {
+        m_locationIndexOk = true;
+        m_locationIdx.clear();
+        for (int i = 0; i < m_messages.count(); i++) {
+            const int idx = m_order.at(i);
+            const TranslatorMessage &msg = m_messages.at(idx);
+            m_locationIdx[LocationKey(msg.fileName(), msg.context())].append(idx);
+        }
+    }
+}
+
+void Translator::ensureReferenceIndexed() const
+{
+    if (!m_referenceIndexOk) {
+        m_referenceIndexOk = true;
+        m_referenceIdx.clear();
+        for (int i = 0; i < m_messages.count(); i++) {
+            const int idx = m_order.at(i);
+            const TranslatorMessage &msg = m_messages.at(idx);
+            for (const TranslatorMessage::Reference &ref : msg.allReferences()) {
+                QList<int> &indexes = m_referenceIdx[TMRKey(msg.context(), msg.comment(), ref)];
+                if (indexes.isEmpty() || indexes.constLast() != idx)
+                    indexes.append(idx);
+            }
+        }
     }
 }
 
 void Translator::replaceSorted(const TranslatorMessage &msg)
 {
-    int index = find(msg);
+    int index = findIndex(msg);
     if (index == -1) {
         appendSorted(msg);
     } else {
         delIndex(index);
+        delLocationIndex(index);
         m_messages[index] = msg;
         addIndex(index, msg);
+        addLocationIndex(index, msg);
     }
 }
 
@@ -112,7 +377,7 @@ static QString makeMsgId(const TranslatorMessage &msg)
 
 void Translator::extend(const TranslatorMessage &msg, ConversionData &cd)
 {
-    int index = find(msg);
+    int index = findIndex(msg);
     if (index == -1) {
         append(msg);
     } else {
@@ -135,7 +400,9 @@ void Translator::extend(const TranslatorMessage &msg, ConversionData &cd)
                                 : QString::fromLatin1("message '%1'").arg(makeMsgId(msg))));
             return;
         }
+        delLocationIndex(index);
         emsg.addReferenceUniq(msg.fileName(), msg.lineNumber());
+        addLocationIndex(index, emsg);
         if (!msg.extraComment().isEmpty()) {
             QString cmt = emsg.extraComment();
             if (!cmt.isEmpty()) {
@@ -152,15 +419,15 @@ void Translator::extend(const TranslatorMessage &msg, ConversionData &cd)
     }
 }
 
-void Translator::insert(int idx, const TranslatorMessage &msg)
+void Translator::insert(int pos, const TranslatorMessage &msg)
 {
-    if (m_indexOk) {
-        if (idx == m_messages.count())
-            addIndex(idx, msg);
-        else
-            m_indexOk = false;
-    }
-    m_messages.insert(idx, msg);
+    // Only m_order learns about the position, so the indexes remain valid
+    const int idx = m_messages.count();
+    m_order.insert(pos, idx);
+    m_messages.append(msg);
+    if (m_indexOk)
+        addIndex(idx, msg);
+    addLocationIndex(idx, msg);
 }
 
 void Translator::append(const TranslatorMessage &msg)
@@ -186,37 +453,57 @@ void Translator::appendSorted(const TranslatorMessage &msg)
     int thisSize = 0;
     // Working vars
     int prevLine = 0;
-    int curIdx = 0;
-    for (const TranslatorMessage &mit : qAsConst(m_messages)) {
-        bool sameFile = mit.fileName() == msg.fileName() && mit.context() == msg.context();
-        int curLine;
-        if (sameFile && (curLine = mit.lineNumber()) >= prevLine) {
-            if (msgLine >= prevLine && msgLine < curLine) {
-                thisIdx = curIdx;
-                thisScore = thisSize ? 2 : 1;
+    int prevIdx = -1;
+
+    // Ends the current region at the message at curIdx
+    auto endRegion = [&](int curIdx) {
+        if (!thisScore) {
+            thisIdx = curIdx;
+            thisScore = 1;
+        }
+        if (thisScore > bestScore || (thisScore == bestScore && thisSize > bestSize)) {
+            bestIdx = thisIdx;
+            bestScore = thisScore;
+            bestSize = thisSize;
+        }
+        thisScore = 0;
+        prevLine = 0;
+    };
+
+    // Regions are runs of messages from the same file and context. Any other
+    // message ends the current region and is otherwise ignored, so only the
+    // message following each run of the same file's positions matters.
+    ensureLocationIndexed();
+    const auto it = m_locationIdx.constFind(LocationKey(msg.fileName(), msg.context()));
+    if (it != m_locationIdx.constEnd()) {
+        for (int idx : *it) {
+            const int curIdx = m_order.indexOf(idx);
+            if (thisSize && curIdx != prevIdx + 1) {
+                endRegion(prevIdx + 1);
+                thisSize = 0;
             }
-            ++thisSize;
-            prevLine = curLine;
-        } else {
-            if (thisSize) {
-                if (!thisScore) {
+            int curLine = m_messages.at(idx).lineNumber();
+            if (curLine >= prevLine) {
+                if (msgLine >= prevLine && msgLine < curLine) {
                     thisIdx = curIdx;
-                    thisScore = 1;
-                }
-                if (thisScore > bestScore || (thisScore == bestScore && thisSize > bestSize)) {
-                    bestIdx = thisIdx;
-                    bestScore = thisScore;
-                    bestSize = thisSize;
+                    thisScore = thisSize ? 2 : 1;
                 }
-                thisScore = 0;
-                thisSize = sameFile ? 1 : 0;
-                prevLine = 0;
+                ++thisSize;
+                prevLine = curLine;
+            } else if (thisSize) {
+                endRegion(curIdx);
+                thisSize = 1;
             }
+            prevIdx = curIdx;
         }
-        ++curIdx;
     }
+    if (thisSize && prevIdx + 1 != m_messages.count()) {
+        endRegion(prevIdx + 1);
+        thisSize = 0;
+    }
+
     if (thisSize && !thisScore) {
-        thisIdx = curIdx;
+        thisIdx = m_messages.count();
         thisScore = 1;
     }
     if (thisScore > bestScore || (thisScore == bestScore && thisSize > bestSize))
@@ -355,6 +642,12 @@ void Translator::languageAndCountry(QStringView languageCode, QLocale::Language
 }
 
 int Translator::find(const TranslatorMessage &msg) const
+{
+    const int idx = findIndex(msg);
+    return idx >= 0 ? m_order.indexOf(idx) : -1;
+}
+
+int Translator::findIndex(const TranslatorMessage &msg) const
 {
     ensureIndexed();
     if (msg.id().isEmpty())
@@ -370,55 +663,66 @@ int Translator::find(const TranslatorMessage &msg) const
 int Translator::find(const QString &context,
     const QString &comment, const TranslatorMessage::References &refs) const
 {
+    // The first message that shares any of the references
+    int found = -1;
     if (!refs.isEmpty()) {
-        for (auto it = m_messages.cbegin(), end = m_messages.cend(); it != end; ++it) {
-            if (it->context() == context && it->comment() == comment) {
-                for (const auto &itref : it->allReferences()) {
-                    for (const auto &ref : refs) {
-                        if (itref == ref)
-                            return it - m_messages.cbegin();
-                    }
-                }
+        ensureReferenceIndexed();
+        for (const auto &ref : refs) {
+            const auto it = m_referenceIdx.constFind(TMRKey(context, comment, ref));
+            if (it != m_referenceIdx.constEnd()) {
+                const int pos = m_order.indexOf(it->constFirst());
+                if (found < 0 || pos < found)
+                    found = pos;
             }
         }
     }
-    return -1;
+    return found;
 }
 
 int Translator::find(const QString &context) const
 {
     ensureIndexed();
-    return m_ctxCmtIdx.value(context, -1);
+    const int idx = m_ctxCmtIdx.value(context, -1);
+    return idx >= 0 ? m_order.indexOf(idx) : -1;
 }
 
 void Translator::stripObsoleteMessages()
 {
+    sortMessages();
     for (auto it = m_messages.begin(); it != m_messages.end(); )
         if (it->type() == TranslatorMessage::Obsolete || it->type() == TranslatorMessage::Vanished)
             it = m_messages.erase(it);
         else
             ++it;
     m_indexOk = false;
+    m_locationIndexOk = false;
+    m_referenceIndexOk = false;
 }
 
 void Translator::stripFinishedMessages()
 {
+    sortMessages();
     for (auto it = m_messages.begin(); it != m_messages.end(); )
         if (it->type() == TranslatorMessage::Finished)
             it = m_messages.erase(it);
         else
             ++it;
     m_indexOk = false;
+    m_locationIndexOk = false;
+    m_referenceIndexOk = false;
 }
 
 void Translator::stripUntranslatedMessages()
 {
+    sortMessages();
     for (auto it = m_messages.begin(); it != m_messages.end(); )
         if (!it->isTranslated())
             it = m_messages.erase(it);
         else
             ++it;
     m_indexOk = false;
+    m_locationIndexOk = false;
+    m_referenceIndexOk = false;
 }
 
 bool Translator::translationsExist() const
@@ -432,26 +736,33 @@ bool Translator::translationsExist() const
 
 void Translator::stripEmptyContexts()
 {
+    sortMessages();
     for (auto it = m_messages.begin(); it != m_messages.end(); )
         if (it->sourceText() == QLatin1String(ContextComment))
             it = m_messages.erase(it);
         else
             ++it;
     m_indexOk = false;
+    m_locationIndexOk = false;
+    m_referenceIndexOk = false;
 }
 
 void Translator::stripNonPluralForms()
 {
+    sortMessages();
     for (auto it = m_messages.begin(); it != m_messages.end(); )
         if (!it->isPlural())
             it = m_messages.erase(it);
         else
             ++it;
     m_indexOk = false;
+    m_locationIndexOk = false;
+    m_referenceIndexOk = false;
 }
 
 void Translator::stripIdenticalSourceTranslations()
 {
+    sortMessages();
     for (auto it = m_messages.begin(); it != m_messages.end(); ) {
         // we need to have just one translation, and it be equal to the source
         if (it->translations().count() == 1 && it->translation() == it->sourceText())
@@ -460,6 +771,8 @@ void Translator::stripIdenticalSourceTranslations()
             ++it;
     }
     m_indexOk = false;
+    m_locationIndexOk = false;
+    m_referenceIndexOk = false;
 }
 
 void Translator::dropTranslations()
@@ -489,6 +802,8 @@ void Translator::dropUiLines()
         }
         message.setReferences(refs);
     }
+    m_locationIndexOk = false;
+    m_referenceIndexOk = false;
 }
 
 struct TranslatorMessageIdPtr {
@@ -554,6 +869,7 @@ inline bool operator==(TranslatorMessageContentPtr tmp1, TranslatorMessageConten
 
 Translator::Duplicates Translator::resolveDuplicates()
 {
+    sortMessages();
     QList<int> duplicateIndices;
     Duplicates dups;
     QHash<TranslatorMessageIdPtr, int> idRefs;
@@ -604,6 +920,8 @@ Translator::Duplicates Translator::resolveDuplicates()
     // now remove the duplicates from the messages
     for (int i = duplicateIndices.size() - 1; i >= 0; --i)
         m_messages.removeAt(duplicateIndices.at(i));
+    m_locationIndexOk = false;
+    m_referenceIndexOk = false;
     return dups;
 }
 
@@ -644,10 +962,13 @@ void Translator::makeFileNamesAbsolute(const QDir &originalPath)
             msg.addReference(fileName, ref.lineNumber());
         }
     }
+    m_locationIndexOk = false;
+    m_referenceIndexOk = false;
 }
 
 const QList<TranslatorMessage> &Translator::messages() const
 {
+    sortMessages();
     return m_messages;
 }
 
@@ -87,6 +87,47 @@ inline size_t qHash(const TMMKey &key)
     return qHash(key.context) ^ qHash(key.source) ^ qHash(key.comment);
 }
 
+class TMRKey {
+public:
+    TMRKey(const QString &ctx, const QString &cmt, const TranslatorMessage::Reference &ref)
+        : context(ctx), comment(cmt), fileName(ref.fileName()), lineNumber(ref.lineNumber()) {}
+    bool operator==(const TMRKey &o) const
+        { return lineNumber == o.lineNumber && context == o.context && comment == o.comment
+                 && fileName == o.fileName; }
+    QString context, comment, fileName;
+    int lineNumber;
+};
+Q_DECLARE_TYPEINFO(TMRKey, Q_RELOCATABLE_TYPE);
+inline size_t qHash(const TMRKey &key)
+{
+    return qHash(key.context) ^ qHash(key.comment) ^ qHash(key.fileName) ^ qHash(key.lineNumber);
+}
+
+// The order of the messages of a Translator, which only ever appends them to
+// its list. Maps the positions of the messages to their indexes in that list
+// and back. It is a treap, so inserting a message in the middle renumbers no
+// other message. It stays empty as long as positions and indexes agree.
+class TMOrder {
+public:
+    bool isEmpty() const { return m_nodes.isEmpty(); }
+    void clear() { m_nodes.clear(); m_root = -1; }
+    void insert(int pos, int idx); // idx must be the number of messages so far
+    int at(int pos) const { return m_nodes.isEmpty() ? pos : nodeAt(pos); }
+    int indexOf(int idx) const { return m_nodes.isEmpty() ? idx : positionOf(idx); }
+    QList<int> toList() const;
+
+private:
+    struct Node { int left, right, parent, size; uint priority; };
+    int size(int node) const { return node < 0 ? 0 : m_nodes.at(node).size; }
+    void add(int pos, int idx);
+    void rotateUp(int node);
+    int nodeAt(int pos) const;
+    int positionOf(int idx) const;
+
+    QList<Node> m_nodes;
+    int m_root = -1;
+};
+
 class Translator
 {
 public:
@@ -140,9 +181,9 @@ public:
     QStringList normalizedTranslations(const TranslatorMessage &m, ConversionData &cd, bool *ok) const;
 
     int messageCount() const { return m_messages.size(); }
-    TranslatorMessage &message(int i) { return m_messages[i]; }
-    const TranslatorMessage &message(int i) const { return m_messages.at(i); }
-    const TranslatorMessage &constMessage(int i) const { return m_messages.at(i); }
+    TranslatorMessage &message(int i) { return m_messages[m_order.at(i)]; }
+    const TranslatorMessage &message(int i) const { return m_messages.at(m_order.at(i)); }
+    const TranslatorMessage &constMessage(int i) const { return m_messages.at(m_order.at(i)); }
     void dump() const;
 
     void setDependencies(const QStringList &dependencies) { m_dependencies = dependencies; }
@@ -181,14 +222,24 @@ public:
     };
 
 private:
-    void insert(int idx, const TranslatorMessage &msg);
+    void insert(int pos, const TranslatorMessage &msg);
+    void sortMessages() const;
+    int findIndex(const TranslatorMessage &msg) const;
     void addIndex(int idx, const TranslatorMessage &msg) const;
     void delIndex(int idx) const;
     void ensureIndexed() const;
-
-    typedef QList<TranslatorMessage> TMM;       // int stores the sequence position.
-
-    TMM m_messages;
+    void addLocationIndex(int idx, const TranslatorMessage &msg) const;
+    void delLocationIndex(int idx) const;
+    void ensureLocationIndexed() const;
+    void ensureReferenceIndexed() const;
+
+    typedef QList<TranslatorMessage> TMM;
+
+    // The messages in the order they were added. m_order tells their actual
+    // order until messages() or a removal of messages sorts them. The indexes
+    // below refer to messages by their index in m_messages.
+    mutable TMM m_messages;
+    mutable TMOrder m_order;
     LocationsType m_locationsType;
 
     // A string beginning with a 2 or 3 letter language code (ISO 639-1
@@ -209,6 +260,17 @@ private:
     mutable QHash<QString, int> m_ctxCmtIdx;
     mutable QHash<QString, int> m_idMsgIdx;
     mutable QHash<TMMKey, int> m_msgIdx;
+
+    // The messages of each file name and context, by ascending position,
+    // so that appendSorted() does not need to look at all messages
+    typedef QPair<QString, QString> LocationKey;
+    mutable bool m_locationIndexOk;
+    mutable QHash<LocationKey, QList<int>> m_locationIdx;
+
+    // The messages with each reference, by ascending position, for the
+    // location based lookup of find(context, comment, refs)
+    mutable bool m_referenceIndexOk;
+    mutable QHash<TMRKey, QList<int>> m_referenceIdx;
 };
 
 bool getNumerusInfo(QLocale::Language language, QLocale::Country country,
@@ -411,13 +411,70 @@ static QString numericEntity(int ch)
         : QLatin1String("&#x%1;")) .arg(ch, 0, 16);
 }
 
+static inline bool needsProtection(char16_t c)
+{
+    switch (c) {
+    case '\"':
+    case '&':
+    case '>':
+    case '<':
+    case '\'':
+        return true;
+    case '\n':
+    case '\t':
+        return false;
+    default:
+        return c < 0x20 || (c > 0x7f && QChar::isSpace(c));
+    }
+}
+
+/*
+  Returns the position of the first character at or after \a from which
+  protect() must escape, or \a len.
+
+  Blocks of plain ASCII are skipped with a branch-free test the compiler can
+  vectorize; only blocks that might contain something are checked exactly.
+*/
+static qsizetype findProtected(const char16_t *s, qsizetype from, qsizetype len)
+{
+    constexpr qsizetype BlockSize = 16;
+    qsizetype i = from;
+    while (i + BlockSize <= len) {
+        bool suspicious = false;
+        for (qsizetype j = i; j < i + BlockSize; ++j) {
+            const char16_t c = s[j];
+            suspicious |= (c < 0x20) | (c > 0x7e) | (c == '"') | (c == '&') | (c == '\'')
+                          | (c == '<') | (c == '>');
+        }
+        if (suspicious) {
+            for (qsizetype j = i; j < i + BlockSize; ++j) {
+                if (needsProtection(s[j]))
+                    return j;
+            }
+        }
+        i += BlockSize;
+    }
+    for (; i < len; ++i) {
+        if (needsProtection(s[i]))
+            return i;
+    }
+    return len;
+}
+
 static QString protect(const QString &str)
 {
+    const char16_t *s = reinterpret_cast<const char16_t *>(str.constData());
+    const qsizetype len = str.size();
+    qsizetype i = findProtected(s, 0, len);
+    if (i == len)
+        return str;
+
     QString result;
-    result.reserve(str.length() * 12 / 10);
-    for (int i = 0; i != str.size(); ++i) {
-        const QChar ch = str[i];
-        uint c = ch.unicode();
+    result.reserve(len * 12 / 10);
+    qsizetype start = 0;
+    while (i < len) {
+        result.append(str.constData() + start, i - start);
+        const char16_t c = s[i];
         switch (c) {
         case '\"':
             result += QLatin1String("&quot;");
@@ -435,12 +492,13 @@ static QString protect(const QString &str)
             result += QLatin1String("&apos;");
             break;
         default:
-            if ((c < 0x20 || (ch > QChar(0x7f) && ch.isSpace())) && c != '\n' && c != '\t')
-                result += numericEntity(c);
-            else // this also covers surrogates
-                result += QChar(c);
+            result += numericEntity(c);
         }
+        start = i + 1;
+        i = findProtected(s, start, len);
     }
+    // surrogates are copied along with the plain runs
+    result.append(str.constData() + start, len - start);
     return result;
 }
 
@@ -116,12 +116,62 @@ static QString numericEntity(int ch, bool makePhs)
               .arg(++id) .arg(name) .arg(escapechar);
 }
 
+static inline bool needsProtection(char16_t c)
+{
+    switch (c) {
+    case '\"':
+    case '&':
+    case '>':
+    case '<':
+    case '\'':
+        return true;
+    default:
+        return c < 0x20 && c != '\r' && c != '\n' && c != '\t';
+    }
+}
+
+// Returns the position of the next character protect() must escape, or \a len.
+// Clean runs are checked in blocks without branches, so that they vectorize.
+static qsizetype findProtected(const char16_t *s, qsizetype from, qsizetype len)
+{
+    constexpr qsizetype BlockSize = 16;
+    qsizetype i = from;
+    while (i + BlockSize <= len) {
+        bool suspicious = false;
+        for (qsizetype j = i; j < i + BlockSize; ++j) {
+            const char16_t c = s[j];
+            suspicious |= (c < 0x20) | (c == '"') | (c == '&') | (c == '\'') | (c == '<')
+                          | (c == '>');
+        }
+        if (suspicious) {
+            for (qsizetype j = i; j < i + BlockSize; ++j) {
+                if (needsProtection(s[j]))
+                    return j;
+            }
+        }
+        i += BlockSize;
+    }
+    for (; i < len; ++i) {
+        if (needsProtection(s[i]))
+            return i;
+    }
+    return len;
+}
+
 static QString protect(const QString &str, bool makePhs = true)
 {
+    const char16_t *s = reinterpret_cast<const char16_t *>(str.constData());
+    const qsizetype len = str.size();
+    qsizetype i = findProtected(s, 0, len);
+    if (i == len)
+        return str;
+
     QString result;
-    int len = str.size();
-    for (int i = 0; i != len; ++i) {
-        uint c = str.at(i).unicode();
+    result.reserve(len + len / 8);
+    qsizetype start = 0;
+    while (i < len) {
+        result.append(str.constData() + start, i - start);
+        const char16_t c = s[i];
         switch (c) {
         case '\"':
             result += QLatin1String("&quot;");
@@ -139,16 +189,16 @@ static QString protect(const QString &str, bool makePhs = true)
             result += QLatin1String("&apos;");
             break;
         default:
-            if (c < 0x20 && c != '\r' && c != '\n' && c != '\t')
-                result += numericEntity(c, makePhs);
-            else // this also covers surrogates
-                result += QChar(c);
+            result += numericEntity(c, makePhs);
         }
+        start = i + 1;
+        i = findProtected(s, start, len);
     }
+    // this also covers surrogates
+    result.append(str.constData() + start, len - start);
     return result;
 }
 
-
 static void writeExtras(QTextStream &ts, int indent,
                         const TranslatorMessage::ExtraData &extras, QRegularExpression drops)
 {
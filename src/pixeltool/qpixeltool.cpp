@@ -82,7 +82,7 @@ void QPixelTool::setPreviewImage(const QImage &image)
 void QPixelTool::timerEvent(QTimerEvent *event)
 {
     if (event->timerId() == m_updateId && !m_freeze) {
-        grabScreen();
+        grabScreen(false);
     } else if (event->timerId() == m_displayZoomId) {
         killTimer(m_displayZoomId);
         m_displayZoomId = 0;
@@ -114,56 +114,62 @@ void render_string(QPainter *p, int w, int h, const QString &text, int flags)
 static QImage imageLCDFilter(const QImage &image, int lcdMode)
 {
     Q_ASSERT(lcdMode > 0 && lcdMode < 5);
+    Q_ASSERT(image.depth() == 32);
     const bool vertical = (lcdMode > 2);
     QImage scaled(image.width()  * (vertical ? 1 : 3),
                   image.height() * (vertical ? 3 : 1),
                   image.format());
 
+    // The masks of the three subpixels, in the order they are laid out
+    const bool rgb = (lcdMode == 1);
+    const QRgb mask0 = rgb ? 0xffff0000 : 0xff0000ff;
+    const QRgb mask1 = 0xff00ff00;
+    const QRgb mask2 = rgb ? 0xff0000ff : 0xffff0000;
+
+    // Straight loops without branches, which the compiler can vectorize
     const int w = image.width();
     const int h = image.height();
-    if (!vertical) {
-        for (int y = 0; y < h; ++y) {
-            const QRgb *in = reinterpret_cast<const QRgb *>(image.scanLine(y));
+    for (int y = 0; y < h; ++y) {
+        const QRgb *in = reinterpret_cast<const QRgb *>(image.constScanLine(y));
+        if (!vertical) {
             QRgb *out = reinterpret_cast<QRgb *>(scaled.scanLine(y));
-            if (lcdMode == 1) {
-                for (int x = 0; x < w; ++x) {
-                    *out++ = in[x] & 0xffff0000;
-                    *out++ = in[x] & 0xff00ff00;
-                    *out++ = in[x] & 0xff0000ff;
-                }
-            } else {
-                for (int x = 0; x < w; ++x) {
-                    *out++ = in[x] & 0xff0000ff;
-                    *out++ = in[x] & 0xff00ff00;
-                    *out++ = in[x] & 0xffff0000;
-                }
+            for (int x = 0; x < w; ++x) {
+                out[3 * x + 0] = in[x] & mask0;
+                out[3 * x + 1] = in[x] & mask1;
+                out[3 * x + 2] = in[x] & mask2;
             }
-        }
-    } else {
-        for (int y = 0; y < h; ++y) {
-            const QRgb *in = reinterpret_cast<const QRgb *>(image.scanLine(y));
-            QRgb *out1 = reinterpret_cast<QRgb *>(scaled.scanLine(y * 3 + 0));
-            QRgb *out2 = reinterpret_cast<QRgb *>(scaled.scanLine(y * 3 + 1));
-            QRgb *out3 = reinterpret_cast<QRgb *>(scaled.scanLine(y * 3 + 2));
-            if (lcdMode == 2) {
-                for (int x = 0; x < w; ++x) {
-                    out1[x] = in[x] & 0xffff0000;
-                    out2[x] = in[x] & 0xff00ff00;
-                    out3[x] = in[x] & 0xff0000ff;
-                }
-            } else {
-                for (int x = 0; x < w; ++x) {
-                    out1[x] = in[x] & 0xff0000ff;
-                    out2[x] = in[x] & 0xff00ff00;
-                    out3[x] = in[x] & 0xffff0000;
-                }
+        } else {
+            QRgb *out0 = reinterpret_cast<QRgb *>(scaled.scanLine(y * 3 + 0));
+            QRgb *out1 = reinterpret_cast<QRgb *>(scaled.scanLine(y * 3 + 1));
+            QRgb *out2 = reinterpret_cast<QRgb *>(scaled.scanLine(y * 3 + 2));
+            for (int x = 0; x < w; ++x) {
+                out0[x] = in[x] & mask0;
+                out1[x] = in[x] & mask1;
+                out2[x] = in[x] & mask2;
             }
         }
     }
     return scaled;
 }
 
-void QPixelTool::paintEvent(QPaintEvent *)
+// Returns the part of an image of \a size, scaled by \a sx and \a sy, that covers \a rect
+static QRect sourceRect(const QRect &rect, const QSize &size, qreal sx, qreal sy)
+{
+    const int left = int(rect.left() / sx);
+    const int top = int(rect.top() / sy);
+    const int right = int((rect.right() + 1) / sx) + 1;
+    const int bottom = int((rect.bottom() + 1) / sy) + 1;
+    return QRect(QPoint(left, top), QPoint(right, bottom)) & QRect(QPoint(0, 0), size);
+}
+
+// Returns \a rect in the device pixels of a pixmap or image with \a devicePixelRatio
+static QRectF deviceRect(const QRect &rect, qreal devicePixelRatio)
+{
+    return QRectF(QPointF(rect.topLeft()) * devicePixelRatio,
+                  QSizeF(rect.size()) * devicePixelRatio);
+}
+
+void QPixelTool::paintEvent(QPaintEvent *event)
 {
     QPainter p(this);
 
@@ -181,16 +187,27 @@ void QPixelTool::paintEvent(QPaintEvent *)
     int w = width();
     int h = height();
 
+    // Only scale the part of the buffer that needs repainting
     p.save();
     if (m_lcdMode == 0)  {
         p.scale(m_zoom, m_zoom);
-        p.drawPixmap(0, 0, m_buffer);
-    } else {
-        if (m_lcdMode <= 2)
-            p.scale(m_zoom / 3.0, m_zoom);
-        else
-            p.scale(m_zoom, m_zoom / 3.0);
-        p.drawImage(0, 0, imageLCDFilter(m_buffer.toImage(), m_lcdMode));
+        const QRect source = sourceRect(event->rect(),
+                                        m_buffer.deviceIndependentSize().toSize(),
+                                        m_zoom, m_zoom);
+        p.drawPixmap(QRectF(source), m_buffer,
+                     deviceRect(source, m_buffer.devicePixelRatio()));
+    } else if (!m_image.isNull()) {
+        if (m_lcdImage.isNull() || m_lcdImageMode != m_lcdMode) {
+            m_lcdImage = imageLCDFilter(m_image, m_lcdMode);
+            m_lcdImageMode = m_lcdMode;
+        }
+        const qreal sx = m_lcdMode <= 2 ? m_zoom / 3.0 : m_zoom;
+        const qreal sy = m_lcdMode <= 2 ? m_zoom : m_zoom / 3.0;
+        p.scale(sx, sy);
+        const QRect source = sourceRect(event->rect(),
+                                        m_lcdImage.deviceIndependentSize().toSize(), sx, sy);
+        p.drawImage(QRectF(source), m_lcdImage,
+                    deviceRect(source, m_lcdImage.devicePixelRatio()));
     }
     p.restore();
 
@@ -330,9 +347,8 @@ void QPixelTool::mouseMoveEvent(QMouseEvent *e)
     const int x = pos.x() / m_zoom;
     const int y = pos.y() / m_zoom;
 
-    QImage im = m_buffer.toImage().convertToFormat(QImage::Format_ARGB32);
-    if (x < im.width() && y < im.height() && x >= 0 && y >= 0) {
-        m_currentColor = im.pixel(x, y);
+    if (x < m_image.width() && y < m_image.height() && x >= 0 && y >= 0) {
+        m_currentColor = m_image.pixel(x, y);
         update();
     }
 }
@@ -483,13 +499,33 @@ static inline QString pixelToolTitle(QPoint pos, const QColor &currentColor)
         + currentColor.name();
 }
 
-void QPixelTool::grabScreen()
+/*
+  Replaces the buffer with a new frame. Returns false, keeping the old
+  buffer, if the frame did not change.
+*/
+bool QPixelTool::setBuffer(const QPixmap &buffer)
+{
+    const QImage image = buffer.toImage().convertToFormat(QImage::Format_ARGB32);
+    if (image == m_image)
+        return false;
+
+    m_buffer = buffer;
+    m_image = image;
+    m_lcdImage = QImage();
+    return true;
+}
+
+/*
+  Grabs the area around the mouse. Unless \a force is true, the widget is
+  only repainted if something in the grabbed area changed.
+*/
+void QPixelTool::grabScreen(bool force)
 {
     if (m_preview_mode) {
         int w = qMin(width() / m_zoom + 1, m_preview_image.width());
         int h = qMin(height() / m_zoom + 1, m_preview_image.height());
-        m_buffer = QPixmap::fromImage(m_preview_image).copy(0, 0, w, h);
-        update();
+        if (setBuffer(QPixmap::fromImage(m_preview_image.copy(0, 0, w, h))) || force)
+            update();
         return;
     }
 
@@ -512,11 +548,12 @@ void QPixelTool::grabScreen()
     int y = mousePos.y() - h/2;
 
     const QBrush darkBrush = palette().color(QPalette::Dark);
+    QPixmap buffer;
     if (QScreen *screen = this->screen()) {
-        m_buffer = screen->grabWindow(0, x, y, w, h);
+        buffer = screen->grabWindow(0, x, y, w, h);
     } else {
-        m_buffer = QPixmap(w, h);
-        m_buffer.fill(darkBrush.color());
+        buffer = QPixmap(w, h);
+        buffer.fill(darkBrush.color());
     }
     QRegion geom(x, y, w, h);
     QRect screenRect;
@@ -526,16 +563,17 @@ void QPixelTool::grabScreen()
     geom -= screenRect;
     const auto rectsInRegion = geom.rectCount();
     if (rectsInRegion > 0) {
-        QPainter p(&m_buffer);
+        QPainter p(&buffer);
         p.translate(-x, -y);
         p.setPen(Qt::NoPen);
         p.setBrush(darkBrush);
         p.drawRects(geom.begin(), rectsInRegion);
     }
 
-    update();
+    if (setBuffer(buffer) || force)
+        update();
 
-    m_currentColor = m_buffer.toImage().pixel(m_buffer.rect().center());
+    m_currentColor = m_image.pixel(m_image.rect().center());
     m_lastMousePos = mousePos;
 }
 
@@ -6,6 +6,7 @@
 
 #include <qwidget.h>
 #include <qpixmap.h>
+#include <qimage.h>
 
 QT_BEGIN_NAMESPACE
 
@@ -49,7 +50,8 @@ protected:
     void contextMenuEvent(QContextMenuEvent *event) override;
 
 private:
-    void grabScreen();
+    void grabScreen(bool force = true);
+    bool setBuffer(const QPixmap &buffer);
     void startZoomVisibleTimer();
     void startGridSizeVisibleTimer();
     QString aboutText() const;
@@ -76,6 +78,9 @@ private:
     QPoint m_dragStart;
     QPoint m_dragCurrent;
     QPixmap m_buffer;
+    QImage m_image; // m_buffer as ARGB32, for reading pixels
+    QImage m_lcdImage; // m_image through the LCD filter, created on demand
+    int m_lcdImageMode = 0;
 
     QSize m_initialSize;
 
@@ -5,8 +5,13 @@
 #include <stdlib.h>
 
 #include <QtCore/QCoreApplication>
+#include <QtCore/QFile>
+#include <QtCore/QHash>
+#include <QtCore/QProcess>
 #include <QtCore/QRegularExpression>
+#include <QtCore/QSharedPointer>
 #include <QtCore/QStringList>
+#include <QtCore/QTextStream>
 #include <QtCore/qmetaobject.h>
 #include <QtXml/QDomDocument>
 #include <QtXml/QDomElement>
@@ -16,9 +21,12 @@
 #include <QtDBus/QDBusVariant>
 #include <QtDBus/QDBusArgument>
 #include <QtDBus/QDBusMessage>
+#include <QtDBus/QDBusPendingCall>
 #include <QtDBus/QDBusReply>
 #include <private/qdbusutil_p.h>
 
+#include <optional>
+
 QT_BEGIN_NAMESPACE
 Q_DBUS_EXPORT extern bool qt_dbus_metaobject_skip_annotations;
 QT_END_NAMESPACE
@@ -29,6 +37,7 @@ static bool printArgumentsLiterally = false;
 static void showUsage()
 {
     printf("Usage: qdbus [--system] [--bus busaddress] [--literal] [servicename] [path] [method] [args]\n"
+           "       qdbus [--system] [--bus busaddress] [--literal] --batch [file]\n"
            "\n"
            "  servicename       the service to connect to (e.g., org.freedesktop.DBus)\n"
            "  path              the path to the object (e.g., /)\n"
@@ -37,11 +46,14 @@ static void showUsage()
            "With 0 arguments, qdbus will list the services available on the bus\n"
            "With just the servicename, qdbus will list the object paths available on the service\n"
            "With service name and object path, qdbus will list the methods, signals and properties available on the object\n"
+           "With --batch, qdbus reads one call per line (servicename path method [args]) from\n"
+           "the file or the standard input, and prints the replies in the same order\n"
            "\n"
            "Options:\n"
            "  --system          connect to the system bus\n"
            "  --bus busaddress  connect to a custom bus\n"
            "  --literal         print replies literally\n"
+           "  --batch [file]    place the calls listed in file, or on the standard input\n"
            );
 }
 
@@ -225,30 +237,57 @@ static QStringList readList(QStringList &args)
     return retval;
 }
 
-static int placeCall(const QString &service, const QString &path, const QString &interface,
-               const QString &member, const QStringList& arguments, bool try_prop=true)
+struct Introspection
 {
-    QDBusInterface iface(service, path, interface, connection);
+    QSharedPointer<QDBusInterface> iface;
+    // member name -> indexes of its overloads, in declaration order
+    QHash<QByteArray, QList<int> > methods;
+};
 
-    // Don't check whether the interface is valid to allow DBus try to
-    // activate the service if possible.
+static QHash<QString, Introspection> introspectionCache;
 
-    QList<int> knownIds;
+static Introspection introspect(const QString &service, const QString &path,
+                                const QString &interface)
+{
+    const QString key = service + QLatin1Char(' ') + path + QLatin1Char(' ') + interface;
+    const auto it = introspectionCache.constFind(key);
+    if (it != introspectionCache.cend())
+        return *it;
+
+    Introspection introspection;
+    introspection.iface.reset(new QDBusInterface(service, path, interface, connection));
+    const QMetaObject *mo = introspection.iface->metaObject();
+    for (int i = mo->methodOffset(); i < mo->methodCount(); ++i) {
+        QByteArray name = mo->method(i).methodSignature();
+        name.truncate(name.indexOf('('));
+        introspection.methods[name].append(i);
+    }
+
+    // Retry later if the service is not there (yet), it might be activatable.
+    if (introspection.iface->isValid())
+        introspectionCache.insert(key, introspection);
+    return introspection;
+}
+
+static int placeCall(const QString &service, const QString &path, const QString &interface,
+               const QString &member, const QStringList& arguments, bool try_prop=true);
+
+/*
+  Converts \a arguments to the parameters of the matching overload of \a member.
+  Returns false if there is nothing to call, with the exit code in \a status.
+*/
+static bool buildParameters(const Introspection &introspection, const QString &service,
+                            const QString &path, const QString &interface,
+                            const QString &member, const QStringList &arguments, bool try_prop,
+                            QVariantList *parameters, int *status)
+{
     bool matchFound = false;
     QStringList args = arguments;
-    QVariantList params;
+    QVariantList &params = *parameters;
+    *status = 0;
     if (!args.isEmpty()) {
-        const QMetaObject *mo = iface.metaObject();
-        QByteArray match = member.toLatin1();
-        match += '(';
-
-        for (int i = mo->methodOffset(); i < mo->methodCount(); ++i) {
-            QMetaMethod mm = mo->method(i);
-            QByteArray signature = mm.methodSignature();
-            if (signature.startsWith(match))
-                knownIds += i;
-         }
-
+        const QMetaObject *mo = introspection.iface->metaObject();
+        QList<int> knownIds = introspection.methods.value(member.toLatin1());
 
         while (!matchFound) {
             args = arguments; // reset
@@ -256,20 +295,23 @@ static int placeCall(const QString &service, const QString &path, const QString
             if (knownIds.isEmpty()) {
                 // Failed to set property after falling back?
                 // Bail out without displaying an error
-                if (!try_prop)
-                    return 1;
+                if (!try_prop) {
+                    *status = 1;
+                    return false;
+                }
                 if (try_prop && args.size() == 1) {
                     QStringList proparg;
                     proparg += interface;
                     proparg += member;
                     proparg += args.first();
                     if (!placeCall(service, path, "org.freedesktop.DBus.Properties", "Set", proparg, false))
-                        return 0;
+                        return false;
                 }
                 fprintf(stderr, "Cannot find '%s.%s' in object %s at %s\n",
                         qPrintable(interface), qPrintable(member), qPrintable(path),
                         qPrintable(service));
-                return 1;
+                *status = 1;
+                return false;
             }
 
             QMetaMethod mm = mo->method(knownIds.takeFirst());
@@ -289,7 +331,8 @@ static int placeCall(const QString &service, const QString &path, const QString
                 if (!metaType.isValid()) {
                     fprintf(stderr, "Cannot call method '%s' because type '%s' is unknown to this tool\n",
                             qPrintable(member), types.at(i).constData());
-                    return 1;
+                    *status = 1;
+                    return false;
                 }
                 const int id = metaType.id();
 
@@ -310,7 +353,8 @@ static int placeCall(const QString &service, const QString &path, const QString
                     if (!p.isValid()) {
                         fprintf(stderr, "Could not convert '%s' to type '%s'.\n",
                                 qPrintable(argument), types.at(i).constData());
-                        return 1 ;
+                        *status = 1;
+                        return false;
                     }
                 } else if (id == qMetaTypeId<QDBusVariant>()) {
                     QDBusVariant tmp(p);
@@ -320,7 +364,8 @@ static int placeCall(const QString &service, const QString &path, const QString
                     if (path.path().isNull()) {
                         fprintf(stderr, "Cannot pass argument '%s' because it is not a valid object path.\n",
                                 qPrintable(argument));
-                        return 1;
+                        *status = 1;
+                        return false;
                     }
                     p = QVariant::fromValue(path);
                 } else if (id == qMetaTypeId<QDBusSignature>()) {
@@ -328,13 +373,15 @@ static int placeCall(const QString &service, const QString &path, const QString
                     if (sig.signature().isNull()) {
                         fprintf(stderr, "Cannot pass argument '%s' because it is not a valid signature.\n",
                                 qPrintable(argument));
-                        return 1;
+                        *status = 1;
+                        return false;
                     }
                     p = QVariant::fromValue(sig);
                 } else {
                     fprintf(stderr, "Sorry, can't pass arg of type '%s'.\n",
                             types.at(i).constData());
-                    return 1;
+                    *status = 1;
+                    return false;
                 }
                 params += p;
             }
@@ -342,12 +389,18 @@ static int placeCall(const QString &service, const QString &path, const QString
                 matchFound = true;
             else if (knownIds.isEmpty()) {
                 fprintf(stderr, "Invalid number of parameters\n");
-                return 1;
+                *status = 1;
+                return false;
             }
         } // while (!matchFound)
     } // if (!args.isEmpty()
 
-    QDBusMessage reply = iface.callWithArgumentList(QDBus::Block, member, params);
+    return true;
+}
+
+static int processReply(const QString &service, const QString &path, const QString &interface,
+                        const QString &member, const QDBusMessage &reply, bool try_prop)
+{
     if (reply.type() == QDBusMessage::ErrorMessage) {
         QDBusError err = reply;
         // Failed to retrieve property after falling back?
@@ -378,6 +431,24 @@ static int placeCall(const QString &service, const QString &path, const QString
     return 0;
 }
 
+static int placeCall(const QString &service, const QString &path, const QString &interface,
+               const QString &member, const QStringList& arguments, bool try_prop)
+{
+    // Don't check whether the interface is valid to allow DBus try to
+    // activate the service if possible.
+    const Introspection introspection = introspect(service, path, interface);
+
+    QVariantList params;
+    int status;
+    if (!buildParameters(introspection, service, path, interface, member, arguments, try_prop,
+                         &params, &status)) {
+        return status;
+    }
+
+    QDBusMessage reply = introspection.iface->callWithArgumentList(QDBus::Block, member, params);
+    return processReply(service, path, interface, member, reply, try_prop);
+}
+
 static bool globServices(QDBusConnectionInterface *bus, const QString &glob)
 {
     QRegularExpression pattern(QRegularExpression::wildcardToRegularExpression(glob));
@@ -414,6 +485,136 @@ static void printAllServices(QDBusConnectionInterface *bus)
     }
 }
 
+// The name checks shared by the command line and --batch. Each prints why
+// the name is rejected.
+static bool checkServiceName(const QString &service)
+{
+    if (QDBusUtil::isValidBusName(service))
+        return true;
+    fprintf(stderr, "Service '%s' is not a valid name.\n", qPrintable(service));
+    return false;
+}
+
+static bool checkObjectPath(const QString &path)
+{
+    if (QDBusUtil::isValidObjectPath(path))
+        return true;
+    fprintf(stderr, "Path '%s' is not a valid path name.\n", qPrintable(path));
+    return false;
+}
+
+// Splits "interface.member" and checks both parts; the interface is optional.
+static bool splitMemberName(const QString &name, QString *interface, QString *member)
+{
+    const int pos = name.lastIndexOf(QLatin1Char('.'));
+    if (pos == -1) {
+        *member = name;
+        interface->clear();
+    } else {
+        *member = name.mid(pos + 1);
+        *interface = name.left(pos);
+    }
+    if (!interface->isEmpty() && !QDBusUtil::isValidInterfaceName(*interface)) {
+        fprintf(stderr, "Interface '%s' is not a valid interface name.\n", qPrintable(*interface));
+        return false;
+    }
+    if (!QDBusUtil::isValidMemberName(*member)) {
+        fprintf(stderr, "Method name '%s' is not a valid member name.\n", qPrintable(*member));
+        return false;
+    }
+    return true;
+}
+
+struct BatchCall
+{
+    QString service;
+    QString path;
+    QString interface;
+    QString member;
+    int status = 0;
+    std::optional<QDBusPendingCall> pending;
+};
+
+static bool parseBatchCall(const QString &line, BatchCall *call, QStringList *arguments)
+{
+    QStringList args = QProcess::splitCommand(line);
+    if (args.size() < 3) {
+        fprintf(stderr, "Batch line '%s' is not a call: expected servicename path method [args]\n",
+                qPrintable(line));
+        return false;
+    }
+
+    call->service = args.takeFirst();
+    if (!checkServiceName(call->service))
+        return false;
+    call->path = args.takeFirst();
+    if (!checkObjectPath(call->path))
+        return false;
+    if (!splitMemberName(args.takeFirst(), &call->interface, &call->member))
+        return false;
+    *arguments = args;
+    return true;
+}
+
+static int finishBatchCall(const BatchCall &call)
+{
+    if (!call.pending)
+        return call.status;
+
+    QDBusPendingCall pending = *call.pending;
+    pending.waitForFinished();
+    return processReply(call.service, call.path, call.interface, call.member, pending.reply(),
+                        true);
+}
+
+/*
+  Places the calls read from \a input, one per line, on the same connection.
+  Each call is sent as soon as it is read, without waiting for the replies
+  of the calls before it, and the replies are printed in input order.
+  Returns the highest exit code of all calls.
+*/
+static int runBatch(QTextStream &input)
+{
+    const qsizetype MaxPendingCalls = 64;
+    QList<BatchCall> queue;
+    int ret = 0;
+
+    QString line;
+    while (input.readLineInto(&line)) {
+        line = line.trimmed();
+        if (line.isEmpty() || line.startsWith(QLatin1Char('#')))
+            continue;
+
+        BatchCall call;
+        QStringList arguments;
+        if (parseBatchCall(line, &call, &arguments)) {
+            const Introspection introspection =
+                    introspect(call.service, call.path, call.interface);
+            QVariantList params;
+            if (buildParameters(introspection, call.service, call.path, call.interface,
+                                call.member, arguments, true, &params, &call.status)) {
+                call.pending =
+                        introspection.iface->asyncCallWithArgumentList(call.member, params);
+            }
+        } else {
+            call.status = 1;
+        }
+        queue.append(call);
+
+        // Print what is ready, so that the output keeps up with a slow input.
+        while (!queue.isEmpty()
+               && (queue.size() > MaxPendingCalls || !queue.first().pending
+                   || queue.first().pending->isFinished())) {
+            ret = qMax(ret, finishBatchCall(queue.takeFirst()));
+        }
+        fflush(stdout);
+    }
+
+    for (const BatchCall &call : qAsConst(queue))
+        ret = qMax(ret, finishBatchCall(call));
+    return ret;
+}
+
 int main(int argc, char **argv)
 {
     QT_PREPEND_NAMESPACE(qt_dbus_metaobject_skip_annotations) = true;
@@ -421,7 +622,11 @@ int main(int argc, char **argv)
     QStringList args = app.arguments();
     args.takeFirst();
 
+    // The cached interfaces must go before the connection does.
+    qAddPostRoutine([] { introspectionCache.clear(); });
+
     bool connectionOpened = false;
+    bool batch = false;
     while (!args.isEmpty() && args.at(0).startsWith(QLatin1Char('-'))) {
         QString arg = args.takeFirst();
         if (arg == QLatin1String("--system")) {
@@ -434,6 +639,8 @@ int main(int argc, char **argv)
             }
         } else if (arg == QLatin1String("--literal")) {
             printArgumentsLiterally = true;
+        } else if (arg == QLatin1String("--batch")) {
+            batch = true;
         } else if (arg == QLatin1String("--help")) {
             showUsage();
             return 0;
@@ -456,6 +663,27 @@ int main(int argc, char **argv)
         return 1;
     }
 
+    if (batch) {
+        QFile file;
+        const QString fileName = args.value(0);
+        if (fileName.isEmpty() || fileName == QLatin1String("-")) {
+            if (!file.open(stdin, QIODevice::ReadOnly | QIODevice::Text)) {
+                fprintf(stderr, "Cannot open standard input: %s\n",
+                        qPrintable(file.errorString()));
+                return 1;
+            }
+        } else {
+            file.setFileName(fileName);
+            if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+                fprintf(stderr, "Cannot open '%s': %s\n", qPrintable(fileName),
+                        qPrintable(file.errorString()));
+                return 1;
+            }
+        }
+        QTextStream input(&file);
+        return runBatch(input);
+    }
+
     QDBusConnectionInterface *bus = connection.interface();
     if (args.isEmpty()) {
         printAllServices(bus);
@@ -463,14 +691,12 @@ int main(int argc, char **argv)
     }
 
     QString service = args.takeFirst();
-    if (!QDBusUtil::isValidBusName(service)) {
-        if (service.contains(QLatin1Char('*'))) {
-            if (globServices(bus, service))
-                return 0;
-        }
-        fprintf(stderr, "Service '%s' is not a valid name.\n", qPrintable(service));
-        return 1;
+    if (!QDBusUtil::isValidBusName(service) && service.contains(QLatin1Char('*'))
+        && globServices(bus, service)) {
+        return 0;
     }
+    if (!checkServiceName(service))
+        return 1;
 
     if (args.isEmpty()) {
         listObjects(service, QString());
@@ -478,33 +704,17 @@ int main(int argc, char **argv)
     }
 
     QString path = args.takeFirst();
-    if (!QDBusUtil::isValidObjectPath(path)) {
-        fprintf(stderr, "Path '%s' is not a valid path name.\n", qPrintable(path));
+    if (!checkObjectPath(path))
         return 1;
-    }
     if (args.isEmpty()) {
         listAllInterfaces(service, path);
         return 0;
     }
 
-    QString interface = args.takeFirst();
+    QString interface;
     QString member;
-    int pos = interface.lastIndexOf(QLatin1Char('.'));
-    if (pos == -1) {
-        member = interface;
-        interface.clear();
-    } else {
-        member = interface.mid(pos + 1);
-        interface.truncate(pos);
-    }
-    if (!interface.isEmpty() && !QDBusUtil::isValidInterfaceName(interface)) {
-        fprintf(stderr, "Interface '%s' is not a valid interface name.\n", qPrintable(interface));
-        exit(1);
-    }
-    if (!QDBusUtil::isValidMemberName(member)) {
-        fprintf(stderr, "Method name '%s' is not a valid member name.\n", qPrintable(member));
+    if (!splitMemberName(args.takeFirst(), &interface, &member))
         return 1;
-    }
 
     int ret = placeCall(service, path, interface, member, args);
     return ret;
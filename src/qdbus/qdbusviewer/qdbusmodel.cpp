@@ -6,12 +6,15 @@
 #include <QtCore/QDebug>
 #include <QtCore/QList>
 
+#include <QtDBus/QDBusMessage>
 #include <QtDBus/QDBusObjectPath>
-#include <QtDBus/QDBusInterface>
-#include <QtDBus/QDBusReply>
+#include <QtDBus/QDBusPendingCallWatcher>
 
 #include <QtXml/QDomDocument>
 
+// Enough to keep the bus busy without flooding slow services
+static const int MaxRunningIntrospections = 8;
+
 struct QDBusItem
 {
     inline QDBusItem(QDBusModel::Type aType, const QString &aName, QDBusItem *aParent = 0)
@@ -46,34 +49,37 @@ struct QDBusItem
     QString typeSignature;
 };
 
-QDomDocument QDBusModel::introspect(const QString &path)
+static QDBusMessage introspectCall(const QString &service, const QString &path)
 {
-    QDomDocument doc;
+    // make a low-level call, to avoid introspecting the Introspectable interface
+    return QDBusMessage::createMethodCall(service, path,
+                                          QLatin1String("org.freedesktop.DBus.Introspectable"),
+                                          QLatin1String("Introspect"));
+}
 
-    QDBusInterface iface(service, path, QLatin1String("org.freedesktop.DBus.Introspectable"), c);
-    if (!iface.isValid()) {
-        QDBusError err(iface.lastError());
-        emit busError(QString::fromLatin1("Cannot introspect object %1 at %2:\n  %3 (%4)\n").arg(path).arg(
-                      service).arg(err.name()).arg(err.message()));
-        return doc;
+/*
+  Returns the XML from \a reply and caches it, or reports the error and
+  returns a null string.
+*/
+QString QDBusModel::introspectionData(const QString &path, const QDBusMessage &reply)
+{
+    if (reply.type() == QDBusMessage::ErrorMessage) {
+        emit busError(QString::fromLatin1("Call to object %1 at %2:\n  %3 (%4) failed\n").arg(
+                    path).arg(service).arg(reply.errorName()).arg(reply.errorMessage()));
+        return QString();
     }
 
-    QDBusReply<QString> xml = iface.call(QLatin1String("Introspect"));
-
-    if (!xml.isValid()) {
-        QDBusError err(xml.error());
-        if (err.isValid()) {
-            emit busError(QString::fromLatin1("Call to object %1 at %2:\n  %3 (%4) failed\n").arg(
-                        path).arg(service).arg(err.name()).arg(err.message()));
-        } else {
-            emit busError(QString::fromLatin1("Invalid XML received from object %1 at %2\n").arg(
-                    path).arg(service));
-        }
-        return doc;
+    const QVariant xml = reply.arguments().value(0);
+    if (reply.type() != QDBusMessage::ReplyMessage
+        || xml.metaType() != QMetaType::fromType<QString>()) {
+        emit busError(QString::fromLatin1("Invalid XML received from object %1 at %2\n").arg(
+                path).arg(service));
+        return QString();
     }
 
-    doc.setContent(xml);
-    return doc;
+    if (cache)
+        (*cache)[service].insert(path, xml.toString());
+    return xml.toString();
 }
 
 void QDBusModel::addMethods(QDBusItem *parent, const QDomElement &iface)
@@ -112,26 +118,26 @@ void QDBusModel::addMethods(QDBusItem *parent, const QDomElement &iface)
     }
 }
 
-void QDBusModel::addPath(QDBusItem *parent)
+void QDBusModel::addPath(QDBusItem *parent, const QString &xml, bool prefetchChildren)
 {
     Q_ASSERT(parent);
 
-    QString path = parent->path();
-
-    QDomDocument doc = introspect(path);
+    QList<QDBusItem *> children;
+    QDomDocument doc;
+    doc.setContent(xml);
     QDomElement node = doc.documentElement();
     QDomElement child = node.firstChildElement();
     while (!child.isNull()) {
         if (child.tagName() == QLatin1String("node")) {
             QDBusItem *item = new QDBusItem(QDBusModel::PathItem,
                         child.attribute(QLatin1String("name")) + QLatin1Char('/'), parent);
-            parent->children.append(item);
+            children.append(item);
 
             addMethods(item, child);
         } else if (child.tagName() == QLatin1String("interface")) {
             QDBusItem *item = new QDBusItem(QDBusModel::InterfaceItem,
                         child.attribute(QLatin1String("name")), parent);
-            parent->children.append(item);
+            children.append(item);
 
             addMethods(item, child);
         } else {
@@ -141,12 +147,151 @@ void QDBusModel::addPath(QDBusItem *parent)
     }
 
     parent->isPrefetched = true;
+    if (!children.isEmpty()) {
+        beginInsertRows(indexOf(parent), 0, children.count() - 1);
+        parent->children = children;
+        endInsertRows();
+    }
+
+    // Look one level ahead, so that expanding a child does not have to wait
+    if (prefetchChildren) {
+        for (QDBusItem *item : qAsConst(parent->children)) {
+            if (!item->isPrefetched)
+                introspect(item, false);
+        }
+    }
+}
+
+/*
+  Queues an asynchronous introspection of \a item. Requests for items the
+  user is waiting for go before the prefetching ones.
+*/
+void QDBusModel::introspect(QDBusItem *item, bool prefetchChildren)
+{
+    Q_ASSERT(item->type == PathItem && !item->isPrefetched);
+
+    const QString path = item->path();
+    if (cache) {
+        const QHash<QString, QString> serviceCache = cache->value(service);
+        const auto cached = serviceCache.constFind(path);
+        if (cached != serviceCache.cend()) {
+            addPath(item, *cached, prefetchChildren);
+            return;
+        }
+    }
+
+    if (requestedPaths.contains(path)) {
+        if (!prefetchChildren)
+            return;
+        for (int i = 0; i < queuedIntrospections.count(); ++i) {
+            if (queuedIntrospections.at(i).path == path) {
+                queuedIntrospections.removeAt(i);
+                queuedIntrospections.prepend({ path, true });
+                break;
+            }
+        }
+        return;
+    }
+
+    requestedPaths.insert(path);
+    if (prefetchChildren)
+        queuedIntrospections.prepend({ path, prefetchChildren });
+    else
+        queuedIntrospections.append({ path, prefetchChildren });
+    startIntrospections();
+}
+
+void QDBusModel::startIntrospections()
+{
+    while (runningIntrospections < MaxRunningIntrospections && !queuedIntrospections.isEmpty()) {
+        const IntrospectionRequest request = queuedIntrospections.takeFirst();
+        QDBusItem *item = findPath(request.path);
+        if (!item || item->isPrefetched) {
+            // removed by a refresh, or already introspected by findObject()
+            requestedPaths.remove(request.path);
+            continue;
+        }
+
+        ++runningIntrospections;
+        QDBusPendingCallWatcher *watcher =
+                new QDBusPendingCallWatcher(c.asyncCall(introspectCall(service, request.path)), this);
+        connect(watcher, &QDBusPendingCallWatcher::finished, this,
+                [this, request](QDBusPendingCallWatcher *call) {
+            call->deleteLater();
+            --runningIntrospections;
+            requestedPaths.remove(request.path);
+            introspectionFinished(request, call->reply());
+            startIntrospections();
+        });
+    }
+}
+
+void QDBusModel::introspectionFinished(const IntrospectionRequest &request,
+                                       const QDBusMessage &reply)
+{
+    QDBusItem *item = findPath(request.path);
+    if (!item || item->isPrefetched)
+        return;
+
+    const QString xml = introspectionData(request.path, reply);
+    if (xml.isNull()) {
+        // don't try again until the user asks for a refresh
+        item->isPrefetched = true;
+        return;
+    }
+    addPath(item, xml, request.prefetchChildren);
+}
+
+// Blocking variant of introspect(), for when the children are needed right away
+void QDBusModel::introspectNow(QDBusItem *item)
+{
+    Q_ASSERT(item->type == PathItem && !item->isPrefetched);
+
+    const QString path = item->path();
+    QString xml;
+    if (cache)
+        xml = cache->value(service).value(path);
+    if (xml.isNull())
+        xml = introspectionData(path, c.call(introspectCall(service, path)));
+    if (xml.isNull())
+        item->isPrefetched = true;
+    else
+        addPath(item, xml, false);
+}
+
+QDBusItem *QDBusModel::findPath(const QString &path) const
+{
+    const QStringList branches = path.split(QLatin1Char('/'), Qt::SkipEmptyParts);
+
+    QDBusItem *item = root;
+    for (const QString &branch : branches) {
+        QDBusItem *next = nullptr;
+        for (QDBusItem *child : qAsConst(item->children)) {
+            if (child->type == PathItem && child->name.chopped(1) == branch) {
+                next = child;
+                break;
+            }
+        }
+        if (!next)
+            return nullptr;
+        item = next;
+    }
+    return item;
 }
 
-QDBusModel::QDBusModel(const QString &aService, const QDBusConnection &connection)
-    : service(aService), c(connection), root(0)
+QModelIndex QDBusModel::indexOf(QDBusItem *item) const
+{
+    if (!item || !item->parent)
+        return QModelIndex();
+    return createIndex(item->parent->children.indexOf(item), 0, item);
+}
+
+QDBusModel::QDBusModel(const QString &aService, const QDBusConnection &connection,
+                       QDBusIntrospectionCache *aCache)
+    : service(aService), c(connection), root(0), cache(aCache), runningIntrospections(0)
 {
     root = new QDBusItem(QDBusModel::PathItem, QLatin1String("/"));
+    introspect(root, true);
 }
 
 QDBusModel::~QDBusModel()
@@ -180,12 +325,39 @@ int QDBusModel::rowCount(const QModelIndex &parent) const
     QDBusItem *item = static_cast<QDBusItem *>(parent.internalPointer());
     if (!item)
         item = root;
-    if (!item->isPrefetched)
-        const_cast<QDBusModel *>(this)->addPath(item);
 
     return item->children.count();
 }
 
+bool QDBusModel::hasChildren(const QModelIndex &parent) const
+{
+    const QDBusItem *item = static_cast<QDBusItem *>(parent.internalPointer());
+    if (!item)
+        item = root;
+
+    // show the expander until we know better
+    return !item->isPrefetched || !item->children.isEmpty();
+}
+
+bool QDBusModel::canFetchMore(const QModelIndex &parent) const
+{
+    const QDBusItem *item = static_cast<QDBusItem *>(parent.internalPointer());
+    if (!item)
+        item = root;
+
+    return !item->isPrefetched;
+}
+
+void QDBusModel::fetchMore(const QModelIndex &parent)
+{
+    QDBusItem *item = static_cast<QDBusItem *>(parent.internalPointer());
+    if (!item)
+        item = root;
+
+    if (!item->isPrefetched)
+        introspect(item, true);
+}
+
 int QDBusModel::columnCount(const QModelIndex &) const
 {
     return 1;
@@ -235,11 +407,21 @@ void QDBusModel::refresh(const QModelIndex &aIndex)
         endRemoveRows();
     }
 
-    addPath(item);
-    if (!item->children.isEmpty()) {
-        beginInsertRows(index, 0, item->children.count() - 1);
-        endInsertRows();
+    if (cache) {
+        // forget about the item and everything below it
+        const QString path = item->path();
+        const QString prefix = path.endsWith(QLatin1Char('/')) ? path : path + QLatin1Char('/');
+        QHash<QString, QString> &serviceCache = (*cache)[service];
+        for (auto it = serviceCache.begin(); it != serviceCache.end(); ) {
+            if (it.key() == path || it.key().startsWith(prefix))
+                it = serviceCache.erase(it);
+            else
+                ++it;
+        }
     }
+
+    item->isPrefetched = false;
+    introspect(item, true);
 }
 
 QString QDBusModel::dBusPath(const QModelIndex &aIndex) const
@@ -284,6 +466,9 @@ QModelIndex QDBusModel::findObject(const QDBusObjectPath &objectPath)
 {
     QStringList path = objectPath.path().split(QLatin1Char('/'), Qt::SkipEmptyParts);
 
+    if (!root->isPrefetched)
+        introspectNow(root);
+
     QDBusItem *item = root;
     int childIdx = -1;
     while (item && !path.isEmpty()) {
@@ -299,7 +484,7 @@ QModelIndex QDBusModel::findObject(const QDBusObjectPath &objectPath)
 
                 // prefetch the found branch
                 if (!item->isPrefetched)
-                    addPath(item);
+                    introspectNow(item);
                 break;
             }
         }
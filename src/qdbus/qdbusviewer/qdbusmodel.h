@@ -5,14 +5,20 @@
 #define QDBUSMODEL_H
 
 #include <QtCore/qabstractitemmodel.h>
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QSet>
 #include <QtDBus/QDBusConnection>
 
 struct QDBusItem;
 
-QT_FORWARD_DECLARE_CLASS(QDomDocument);
 QT_FORWARD_DECLARE_CLASS(QDomElement);
+QT_FORWARD_DECLARE_CLASS(QDBusMessage)
 QT_FORWARD_DECLARE_CLASS(QDBusObjectPath)
 
+// Introspection XML by service name and object path
+typedef QHash<QString, QHash<QString, QString> > QDBusIntrospectionCache;
+
 
 class QDBusModel: public QAbstractItemModel
 {
@@ -21,13 +27,17 @@ class QDBusModel: public QAbstractItemModel
 public:
     enum Type { InterfaceItem, PathItem, MethodItem, SignalItem, PropertyItem };
 
-    QDBusModel(const QString &service, const QDBusConnection &connection);
+    QDBusModel(const QString &service, const QDBusConnection &connection,
+               QDBusIntrospectionCache *cache);
     ~QDBusModel();
 
 
     QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override;
     QModelIndex parent(const QModelIndex &child) const override;
     int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    bool hasChildren(const QModelIndex &parent = QModelIndex()) const override;
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
     int columnCount(const QModelIndex &parent = QModelIndex()) const override;
     QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
     QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
@@ -46,13 +56,29 @@ Q_SIGNALS:
     void busError(const QString &text);
 
 private:
-    QDomDocument introspect(const QString &path);
+    struct IntrospectionRequest
+    {
+        QString path;
+        bool prefetchChildren;
+    };
+
     void addMethods(QDBusItem *parent, const QDomElement &iface);
-    void addPath(QDBusItem *parent);
+    void addPath(QDBusItem *parent, const QString &xml, bool prefetchChildren);
+    void introspect(QDBusItem *item, bool prefetchChildren);
+    void introspectNow(QDBusItem *item);
+    void startIntrospections();
+    void introspectionFinished(const IntrospectionRequest &request, const QDBusMessage &reply);
+    QString introspectionData(const QString &path, const QDBusMessage &reply);
+    QDBusItem *findPath(const QString &path) const;
+    QModelIndex indexOf(QDBusItem *item) const;
 
     QString service;
     QDBusConnection c;
     QDBusItem *root;
+    QDBusIntrospectionCache *cache;
+    QList<IntrospectionRequest> queuedIntrospections;
+    QSet<QString> requestedPaths; // queued or running
+    int runningIntrospections;
 };
 
 #endif
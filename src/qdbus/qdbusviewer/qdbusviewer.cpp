@@ -6,6 +6,7 @@
 #include "servicesproxymodel.h"
 #include "propertydialog.h"
 #include "logviewer.h"
+#include "signalmonitor.h"
 
 #include <QtWidgets/QLineEdit>
 #include <QtWidgets/QVBoxLayout>
@@ -13,6 +14,7 @@
 #include <QtWidgets/QInputDialog>
 #include <QtWidgets/QMessageBox>
 #include <QtWidgets/QMenu>
+#include <QtWidgets/QTabWidget>
 #include <QtWidgets/QTableWidget>
 #include <QtWidgets/QTreeWidget>
 #include <QtWidgets/QHeaderView>
@@ -34,8 +36,9 @@
 class QDBusViewModel: public QDBusModel
 {
 public:
-    inline QDBusViewModel(const QString &service, const QDBusConnection &connection)
-        : QDBusModel(service, connection)
+    inline QDBusViewModel(const QString &service, const QDBusConnection &connection,
+                          QDBusIntrospectionCache *cache)
+        : QDBusModel(service, connection, cache)
     {}
 
     QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override
@@ -111,6 +114,12 @@ QDBusViewer::QDBusViewer(const QDBusConnection &connection, QWidget *parent)  :
     log = new LogViewer;
     connect(log, &QTextBrowser::anchorClicked, this, &QDBusViewer::anchorClicked);
 
+    signalMonitor = new SignalMonitor;
+
+    logTabs = new QTabWidget;
+    logTabs->addTab(log, tr("Log"));
+    logTabs->addTab(signalMonitor, tr("Signal Monitor"));
+
     splitter = new QSplitter(topSplitter);
     splitter->addWidget(servicesView);
 
@@ -123,7 +132,7 @@ QDBusViewer::QDBusViewer(const QDBusConnection &connection, QWidget *parent)  :
     splitter->addWidget(tree);
 
     topSplitter->addWidget(splitter);
-    topSplitter->addWidget(log);
+    topSplitter->addWidget(logTabs);
 
     connect(servicesView->selectionModel(), &QItemSelectionModel::currentChanged, this, &QDBusViewer::serviceChanged);
     connect(tree, &QWidget::customContextMenuRequested, this, &QDBusViewer::showContextMenu);
@@ -362,6 +371,9 @@ void QDBusViewer::showContextMenu(const QPoint &point)
         QAction *action = new QAction(tr("&Connect"), &menu);
         action->setData(1);
         menu.addAction(action);
+        QAction *actionMonitor = new QAction(tr("&Monitor"), &menu);
+        actionMonitor->setData(5);
+        menu.addAction(actionMonitor);
         break; }
     case QDBusModel::MethodItem: {
         QAction *action = new QAction(tr("&Call"), &menu);
@@ -397,6 +409,9 @@ void QDBusViewer::showContextMenu(const QPoint &point)
     case 4:
         getProperty(sig);
         break;
+    case 5:
+        monitorRequested(sig);
+        break;
     }
 }
 
@@ -412,6 +427,19 @@ void QDBusViewer::connectionRequested(const BusSignature &sig)
     }
 }
 
+// For signals that fire too often to be dumped into the log
+void QDBusViewer::monitorRequested(const BusSignature &sig)
+{
+    if (signalMonitor->monitor(c, sig.mService, sig.mInterface, sig.mName)) {
+        logMessage(tr("Monitoring service %1, interface %2, signal %3").arg(
+                    sig.mService, sig.mInterface, sig.mName));
+        logTabs->setCurrentWidget(signalMonitor);
+    } else {
+        logError(tr("Unable to monitor service %1, interface %2, signal %3").arg(
+                    sig.mService, sig.mInterface, sig.mName));
+    }
+}
+
 void QDBusViewer::dumpMessage(const QDBusMessage &message)
 {
     QList<QVariant> args = message.arguments();
@@ -474,7 +502,7 @@ void QDBusViewer::serviceChanged(const QModelIndex &index)
         return;
     currentService = index.data().toString();
 
-    QDBusViewModel *model = new QDBusViewModel(currentService, c);
+    QDBusViewModel *model = new QDBusViewModel(currentService, c, &introspectionCache);
     tree->setModel(model);
     connect(model, &QDBusModel::busError, this, &QDBusViewer::logError);
 }
@@ -508,6 +536,13 @@ void QDBusViewer::serviceUnregistered(const QString &name)
 void QDBusViewer::serviceOwnerChanged(const QString &name, const QString &oldOwner,
                                       const QString &newOwner)
 {
+    // whatever we know about the objects of the old owner is outdated
+    introspectionCache.remove(name);
+    if (name == currentService && !newOwner.isEmpty()) {
+        if (QDBusModel *model = qobject_cast<QDBusModel *>(tree->model()))
+            model->refresh();
+    }
+
     QModelIndex hit = findItem(servicesModel, name);
 
     if (!hit.isValid() && oldOwner.isEmpty() && !newOwner.isEmpty())
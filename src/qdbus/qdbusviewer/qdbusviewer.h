@@ -8,7 +8,10 @@
 #include <QtDBus/QDBusConnection>
 #include <QtCore/QRegularExpression>
 
+#include "qdbusmodel.h"
+
 class ServicesProxyModel;
+class SignalMonitor;
 
 QT_FORWARD_DECLARE_CLASS(QTableView)
 QT_FORWARD_DECLARE_CLASS(QTreeView)
@@ -20,6 +23,7 @@ QT_FORWARD_DECLARE_CLASS(QDomDocument)
 QT_FORWARD_DECLARE_CLASS(QDomElement)
 QT_FORWARD_DECLARE_CLASS(QSplitter)
 QT_FORWARD_DECLARE_CLASS(QSettings)
+QT_FORWARD_DECLARE_CLASS(QTabWidget)
 
 struct BusSignature
 {
@@ -43,6 +47,7 @@ private slots:
     void serviceChanged(const QModelIndex &index);
     void showContextMenu(const QPoint &);
     void connectionRequested(const BusSignature &sig);
+    void monitorRequested(const BusSignature &sig);
     void callMethod(const BusSignature &sig);
     void getProperty(const BusSignature &sig);
     void setProperty(const BusSignature &sig);
@@ -75,9 +80,12 @@ private:
     QLineEdit *serviceFilterLine;
     QTableView *servicesView;
     QTextBrowser *log;
+    SignalMonitor *signalMonitor;
+    QTabWidget *logTabs;
     QSplitter *topSplitter;
     QSplitter *splitter;
     QRegularExpression objectPathRegExp;
+    QDBusIntrospectionCache introspectionCache;
 };
 
 #endif
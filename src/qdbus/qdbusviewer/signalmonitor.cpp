@@ -0,0 +1,337 @@
+// Copyright (C) 2022 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include "signalmonitor.h"
+
+#include <QtWidgets/QFileDialog>
+#include <QtWidgets/QHBoxLayout>
+#include <QtWidgets/QHeaderView>
+#include <QtWidgets/QLabel>
+#include <QtWidgets/QLineEdit>
+#include <QtWidgets/QMessageBox>
+#include <QtWidgets/QScrollBar>
+#include <QtWidgets/QSplitter>
+#include <QtWidgets/QTableView>
+#include <QtWidgets/QToolButton>
+#include <QtWidgets/QTreeWidget>
+#include <QtWidgets/QVBoxLayout>
+
+#include <QtCore/QDateTime>
+#include <QtCore/QSaveFile>
+#include <QtCore/QSortFilterProxyModel>
+#include <QtCore/QTextStream>
+
+#include <private/qdbusutil_p.h>
+
+static const int LogCapacity = 10000;
+static const int FlushInterval = 100; // ms
+
+SignalLogModel::SignalLogModel(int aCapacity, QObject *parent)
+    : QAbstractTableModel(parent), capacity(aCapacity), first(0), count(0)
+{
+    entries.resize(capacity);
+
+    flushTimer.setSingleShot(true);
+    flushTimer.setInterval(FlushInterval);
+    connect(&flushTimer, &QTimer::timeout, this, &SignalLogModel::flush);
+}
+
+int SignalLogModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : count;
+}
+
+int SignalLogModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant SignalLogModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= count || role != Qt::DisplayRole)
+        return QVariant();
+
+    const Entry &e = entry(index.row());
+    switch (index.column()) {
+    case TimeColumn:
+        return QDateTime::fromMSecsSinceEpoch(e.time).time().toString(
+                QLatin1String("hh:mm:ss.zzz"));
+    case SenderColumn:
+        return e.message.service();
+    case PathColumn:
+        return e.message.path();
+    case InterfaceColumn:
+        return e.message.interface();
+    case MemberColumn:
+        return e.message.member();
+    case ArgumentsColumn: {
+        QString out;
+        const QList<QVariant> args = e.message.arguments();
+        for (const QVariant &arg : args) {
+            if (!out.isEmpty())
+                out += QLatin1String(", ");
+            out += QDBusUtil::argumentToString(arg);
+        }
+        return out;
+    }
+    default:
+        return QVariant();
+    }
+}
+
+QVariant SignalLogModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole)
+        return QVariant();
+
+    switch (section) {
+    case TimeColumn:
+        return tr("Time");
+    case SenderColumn:
+        return tr("Sender");
+    case PathColumn:
+        return tr("Path");
+    case InterfaceColumn:
+        return tr("Interface");
+    case MemberColumn:
+        return tr("Signal");
+    case ArgumentsColumn:
+        return tr("Arguments");
+    default:
+        return QVariant();
+    }
+}
+
+void SignalLogModel::append(const QDBusMessage &message)
+{
+    // Older messages would be pushed out by the next flush anyway
+    if (pending.count() == capacity)
+        pending.removeFirst();
+    pending.append({ QDateTime::currentMSecsSinceEpoch(), message });
+    if (!flushTimer.isActive())
+        flushTimer.start();
+}
+
+void SignalLogModel::clear()
+{
+    flushTimer.stop();
+    pending.clear();
+    beginResetModel();
+    for (Entry &e : entries)
+        e = Entry();
+    first = 0;
+    count = 0;
+    endResetModel();
+}
+
+void SignalLogModel::flush()
+{
+    const int added = pending.count();
+    if (!added)
+        return;
+
+    const int removed = qMax(0, count + added - capacity);
+    if (removed) {
+        beginRemoveRows(QModelIndex(), 0, removed - 1);
+        for (int i = 0; i < removed; ++i)
+            entries[(first + i) % capacity] = Entry();
+        first = (first + removed) % capacity;
+        count -= removed;
+        endRemoveRows();
+    }
+
+    beginInsertRows(QModelIndex(), count, count + added - 1);
+    for (int i = 0; i < added; ++i)
+        entries[(first + count + i) % capacity] = pending.at(i);
+    count += added;
+    endInsertRows();
+
+    pending.clear();
+}
+
+SignalMonitor::SignalMonitor(QWidget *parent)
+    : QWidget(parent), followTail(true)
+{
+    model = new SignalLogModel(LogCapacity, this);
+    proxyModel = new QSortFilterProxyModel(this);
+    proxyModel->setSourceModel(model);
+    proxyModel->setFilterCaseSensitivity(Qt::CaseInsensitive);
+    proxyModel->setFilterKeyColumn(-1);
+
+    filterLine = new QLineEdit;
+    filterLine->setPlaceholderText(tr("Filter..."));
+    filterLine->setClearButtonEnabled(true);
+    connect(filterLine, &QLineEdit::textChanged,
+            proxyModel, &QSortFilterProxyModel::setFilterFixedString);
+
+    pauseButton = new QToolButton;
+    pauseButton->setText(tr("Pause"));
+    pauseButton->setCheckable(true);
+
+    QToolButton *clearButton = new QToolButton;
+    clearButton->setText(tr("Clear"));
+    connect(clearButton, &QToolButton::clicked, this, &SignalMonitor::clear);
+
+    QToolButton *exportButton = new QToolButton;
+    exportButton->setText(tr("Export..."));
+    connect(exportButton, &QToolButton::clicked, this, &SignalMonitor::exportLog);
+
+    QToolButton *stopButton = new QToolButton;
+    stopButton->setText(tr("Stop"));
+    connect(stopButton, &QToolButton::clicked, this, &SignalMonitor::stopMonitoring);
+
+    statusLabel = new QLabel;
+
+    view = new QTableView;
+    view->setModel(proxyModel);
+    view->verticalHeader()->hide();
+    // fixed row heights keep scrolling through the whole buffer cheap
+    view->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    view->verticalHeader()->setDefaultSectionSize(view->fontMetrics().height() + 4);
+    view->horizontalHeader()->setStretchLastSection(true);
+    view->setShowGrid(false);
+    view->setWordWrap(false);
+    view->setSelectionBehavior(QAbstractItemView::SelectRows);
+    connect(proxyModel, &QAbstractItemModel::rowsAboutToBeInserted, this, [this] {
+        const QScrollBar *bar = view->verticalScrollBar();
+        followTail = bar->value() == bar->maximum();
+    });
+    connect(proxyModel, &QAbstractItemModel::rowsInserted, this, [this] {
+        if (followTail)
+            view->scrollToBottom();
+    });
+
+    rates = new QTreeWidget;
+    rates->setRootIsDecorated(false);
+    rates->setHeaderLabels({ tr("Signal"), tr("Per second"), tr("Total") });
+    rates->setSortingEnabled(true);
+    rates->sortByColumn(1, Qt::DescendingOrder);
+
+    QHBoxLayout *toolLayout = new QHBoxLayout;
+    toolLayout->setContentsMargins(QMargins());
+    toolLayout->addWidget(filterLine);
+    toolLayout->addWidget(pauseButton);
+    toolLayout->addWidget(clearButton);
+    toolLayout->addWidget(exportButton);
+    toolLayout->addWidget(stopButton);
+
+    QSplitter *splitter = new QSplitter;
+    splitter->addWidget(view);
+    splitter->addWidget(rates);
+    splitter->setStretchFactor(0, 3);
+    splitter->setStretchFactor(1, 1);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->addLayout(toolLayout);
+    layout->addWidget(splitter);
+    layout->addWidget(statusLabel);
+
+    rateTimer.setInterval(1000);
+    connect(&rateTimer, &QTimer::timeout, this, &SignalMonitor::rollOverRates);
+    rateTimer.start();
+
+    updateRates();
+}
+
+SignalMonitor::~SignalMonitor()
+{
+    stopMonitoring();
+}
+
+bool SignalMonitor::monitor(const QDBusConnection &connection, const QString &service,
+                            const QString &interface, const QString &name)
+{
+    QDBusConnection c = connection;
+    if (!c.connect(service, QString(), interface, name, this, SLOT(addMessage(QDBusMessage))))
+        return false;
+
+    subscriptions.append({ connection, service, interface, name });
+    updateRates();
+    return true;
+}
+
+void SignalMonitor::addMessage(const QDBusMessage &message)
+{
+    ++rateCounters[message.interface() + QLatin1Char('.') + message.member()].currentSecond;
+    if (!pauseButton->isChecked())
+        model->append(message);
+}
+
+void SignalMonitor::stopMonitoring()
+{
+    for (Subscription &s : subscriptions) {
+        s.connection.disconnect(s.service, QString(), s.interface, s.name,
+                                this, SLOT(addMessage(QDBusMessage)));
+    }
+    subscriptions.clear();
+    updateRates();
+}
+
+void SignalMonitor::clear()
+{
+    model->clear();
+    rateCounters.clear();
+    rates->clear();
+    updateRates();
+}
+
+// Writes the messages that pass the filter, one per line, as tab-separated fields
+void SignalMonitor::exportLog()
+{
+    const QString fileName = QFileDialog::getSaveFileName(this, tr("Export Signals"), QString(),
+                                                          tr("Text files (*.txt *.log)"));
+    if (fileName.isEmpty())
+        return;
+
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        QMessageBox::warning(this, tr("Export Signals"),
+                             tr("Cannot write %1:\n%2").arg(fileName, file.errorString()));
+        return;
+    }
+
+    QTextStream out(&file);
+    const int columns = proxyModel->columnCount();
+    for (int row = 0; row < proxyModel->rowCount(); ++row) {
+        for (int column = 0; column < columns; ++column) {
+            if (column)
+                out << '\t';
+            out << proxyModel->index(row, column).data().toString();
+        }
+        out << '\n';
+    }
+    out.flush();
+
+    if (!file.commit()) {
+        QMessageBox::warning(this, tr("Export Signals"),
+                             tr("Cannot write %1:\n%2").arg(fileName, file.errorString()));
+    }
+}
+
+// Called once a second by the rate timer, closes the current interval
+void SignalMonitor::rollOverRates()
+{
+    for (RateCounter &counter : rateCounters) {
+        counter.total += counter.currentSecond;
+        counter.lastSecond = counter.currentSecond;
+        counter.currentSecond = 0;
+    }
+    updateRates();
+}
+
+void SignalMonitor::updateRates()
+{
+    rates->setSortingEnabled(false);
+    for (auto it = rateCounters.cbegin(), end = rateCounters.cend(); it != end; ++it) {
+        const RateCounter &counter = it.value();
+        const QList<QTreeWidgetItem *> items = rates->findItems(it.key(), Qt::MatchExactly);
+        QTreeWidgetItem *item = items.isEmpty() ? new QTreeWidgetItem(rates, { it.key() })
+                                                : items.first();
+        item->setData(1, Qt::DisplayRole, counter.lastSecond);
+        item->setData(2, Qt::DisplayRole, counter.total);
+    }
+    rates->setSortingEnabled(true);
+
+    statusLabel->setText(tr("Monitoring %n signal(s), the last %1 messages are kept", nullptr,
+                            subscriptions.count()).arg(LogCapacity));
+}
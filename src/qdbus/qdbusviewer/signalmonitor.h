@@ -0,0 +1,114 @@
+// Copyright (C) 2022 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#ifndef SIGNALMONITOR_H
+#define SIGNALMONITOR_H
+
+#include <QtWidgets/QWidget>
+#include <QtCore/QAbstractTableModel>
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QTimer>
+#include <QtDBus/QDBusConnection>
+#include <QtDBus/QDBusMessage>
+
+QT_FORWARD_DECLARE_CLASS(QLabel)
+QT_FORWARD_DECLARE_CLASS(QLineEdit)
+QT_FORWARD_DECLARE_CLASS(QSortFilterProxyModel)
+QT_FORWARD_DECLARE_CLASS(QTableView)
+QT_FORWARD_DECLARE_CLASS(QToolButton)
+QT_FORWARD_DECLARE_CLASS(QTreeWidget)
+
+/*
+  Keeps the last received messages in a ring buffer of fixed size. The
+  messages are stored as they are and only formatted when a view asks
+  for them. Incoming messages are added to the model in batches, so that
+  a chatty signal does not cause a model update per message.
+*/
+class SignalLogModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum Column { TimeColumn, SenderColumn, PathColumn, InterfaceColumn, MemberColumn,
+                  ArgumentsColumn, ColumnCount };
+
+    explicit SignalLogModel(int capacity, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation,
+                        int role = Qt::DisplayRole) const override;
+
+    void append(const QDBusMessage &message);
+    void clear();
+
+private:
+    struct Entry
+    {
+        qint64 time = 0; // msecs since epoch
+        QDBusMessage message;
+    };
+
+    void flush();
+    const Entry &entry(int row) const { return entries.at((first + row) % capacity); }
+
+    QList<Entry> entries; // the ring buffer, capacity entries
+    QList<Entry> pending; // received, but not yet in the model
+    int capacity;
+    int first;
+    int count;
+    QTimer flushTimer;
+};
+
+class SignalMonitor : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit SignalMonitor(QWidget *parent = nullptr);
+    ~SignalMonitor();
+
+    bool monitor(const QDBusConnection &connection, const QString &service,
+                 const QString &interface, const QString &name);
+
+public slots:
+    void addMessage(const QDBusMessage &message);
+    void stopMonitoring();
+    void clear();
+    void exportLog();
+
+private:
+    void rollOverRates();
+    void updateRates();
+
+    struct Subscription
+    {
+        QDBusConnection connection;
+        QString service;
+        QString interface;
+        QString name;
+    };
+
+    struct RateCounter
+    {
+        quint64 total = 0;
+        int currentSecond = 0; // messages in the running interval
+        int lastSecond = 0; // messages in the last full interval
+    };
+
+    SignalLogModel *model;
+    QSortFilterProxyModel *proxyModel;
+    QTableView *view;
+    QTreeWidget *rates;
+    QLineEdit *filterLine;
+    QToolButton *pauseButton;
+    QLabel *statusLabel;
+    QList<Subscription> subscriptions;
+    QHash<QString, RateCounter> rateCounters; // by interface.member
+    QTimer rateTimer;
+    bool followTail; // keep the newest message in view
+};
+
+#endif // SIGNALMONITOR_H
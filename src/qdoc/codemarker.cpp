@@ -383,6 +383,58 @@ QString CodeMarker::taggedQmlNode(const Node *node)
             + tag + QLatin1Char('>');
 }
 
+/*!
+  Splits \a markedCode into text and the tags that the code markers
+  insert, in a single pass. The returned tokens refer to \a markedCode.
+
+  A \c{<} that does not start a complete \c{<@...>} or \c{</@...>} tag
+  is part of the text.
+ */
+MarkupTokens CodeMarker::tokenize(QStringView markedCode)
+{
+    MarkupTokens tokens;
+    const qsizetype n = markedCode.size();
+    qsizetype textStart = 0;
+    qsizetype i = markedCode.indexOf(QLatin1Char('<'));
+    while (i >= 0) {
+        const bool closing = i + 1 < n && markedCode.at(i + 1) == QLatin1Char('/');
+        const qsizetype at = i + (closing ? 2 : 1);
+        const qsizetype end = at < n && markedCode.at(at) == QLatin1Char('@')
+                ? markedCode.indexOf(QLatin1Char('>'), at)
+                : -1;
+        if (end < 0) {
+            i = markedCode.indexOf(QLatin1Char('<'), i + 1);
+            continue;
+        }
+
+        if (i > textStart)
+            tokens.append({ MarkupToken::Text, markedCode.sliced(textStart, i - textStart) });
+
+        MarkupToken tag;
+        tag.kind = closing ? MarkupToken::CloseTag : MarkupToken::OpenTag;
+        tag.text = markedCode.sliced(i, end + 1 - i);
+        qsizetype nameEnd = at + 1;
+        while (nameEnd < end && markedCode.at(nameEnd) != QLatin1Char(' '))
+            ++nameEnd;
+        tag.name = markedCode.sliced(at + 1, nameEnd - at - 1);
+        if (!closing) {
+            const qsizetype quote = markedCode.indexOf(QLatin1Char('"'), nameEnd);
+            if (quote >= 0 && quote < end) {
+                const qsizetype endQuote = markedCode.indexOf(QLatin1Char('"'), quote + 1);
+                if (endQuote >= 0 && endQuote < end)
+                    tag.target = markedCode.sliced(quote + 1, endQuote - quote - 1);
+            }
+        }
+        tokens.append(tag);
+
+        textStart = end + 1;
+        i = markedCode.indexOf(QLatin1Char('<'), textStart);
+    }
+    if (textStart < n)
+        tokens.append({ MarkupToken::Text, markedCode.sliced(textStart) });
+    return tokens;
+}
+
 QString CodeMarker::linkTag(const Node *node, const QString &body)
 {
     return QLatin1String("<@link node=\"") + stringForNode(node) + QLatin1String("\">") + body
@@ -9,6 +9,30 @@
 
 QT_BEGIN_NAMESPACE
 
+/*
+  A piece of code marked up by a code marker: plain text, or the opening
+  or closing tag of an element such as <@type>. The views refer to the
+  marked-up string, which must outlive the tokens.
+*/
+struct MarkupToken
+{
+    enum Kind : quint8 { Text, OpenTag, CloseTag };
+
+    Kind kind = Text;
+    QStringView text; // the text, or the whole tag including the angle brackets
+    QStringView name; // the tag name without '@', for example "link"
+    QStringView target; // the value of the tag's attribute, as in <@link node="...">
+
+    // True for tags without attributes, like <@type> and </@type>
+    [[nodiscard]] bool isPlainTag(QLatin1String tagName) const
+    {
+        return kind != Text && name == tagName
+                && text.size() == tagName.size() + (kind == OpenTag ? 3 : 4);
+    }
+};
+
+using MarkupTokens = QList<MarkupToken>;
+
 class CodeMarker
 {
 public:
@@ -47,6 +71,7 @@ public:
     static const Node *nodeForString(const QString &string);
     static QString stringForNode(const Node *node);
     static QString extraSynopsis(const Node *node, Section::Style style);
+    static MarkupTokens tokenize(QStringView markedCode);
 
     QString typified(const QString &string, bool trailingSpace = false);
 
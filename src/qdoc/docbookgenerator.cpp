@@ -209,9 +209,14 @@ const Atom *DocBookGenerator::generateAtomList(const Atom *atom, const Node *rel
 }
 
 QString removeCodeMarkers(const QString& code) {
-    QString rewritten = code;
-    QRegularExpression re("(<@[^>&]*>)|(<\\/@[^&>]*>)");
-    rewritten.replace(re, "");
+    // Tags containing entities are not code markers, keep them as text
+    QString rewritten;
+    rewritten.reserve(code.size());
+    const MarkupTokens tokens = CodeMarker::tokenize(code);
+    for (const MarkupToken &token : tokens) {
+        if (token.kind == MarkupToken::Text || token.text.contains(QLatin1Char('&')))
+            rewritten += token.text;
+    }
     return rewritten;
 }
 
@@ -3305,7 +3310,7 @@ void DocBookGenerator::generateParameter(const Parameter &parameter, const Node
     if (generateExtra || pname.isEmpty()) {
         // Look for the _ character in the member name followed by a number (or n):
         // this is intended to be rendered as a subscript.
-        QRegularExpression sub("([a-z]+)_([0-9]+|n)");
+        static const QRegularExpression sub("([a-z]+)_([0-9]+|n)");
 
         m_writer->writeStartElement(dbNamespace, "emphasis");
         auto match = sub.match(paramName);
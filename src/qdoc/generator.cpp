@@ -52,11 +52,6 @@ bool Generator::s_redirectDocumentationToDevNull = false;
 bool Generator::s_useOutputSubdirs = true;
 QmlTypeNode *Generator::s_qmlTypeContext = nullptr;
 
-static QRegularExpression tag("</?@[^>]*>");
-static QLatin1String amp("&amp;");
-static QLatin1String gt("&gt;");
-static QLatin1String lt("&lt;");
-static QLatin1String quot("&quot;");
 
 /*!
   Constructs the generator base class. Prepends the newly
@@ -1833,104 +1828,42 @@ QString Generator::outputSuffix(const Node *node)
     return QString();
 }
 
-bool Generator::parseArg(const QString &src, const QString &tag, int *pos, int n,
-                         QStringView *contents, QStringView *par1, bool debug)
+/*!
+  Returns \a markedCode without the code marker tags and with the
+  entities that CodeMarker::protect() inserts replaced by the characters
+  they stand for.
+ */
+QString Generator::plainCode(const QString &markedCode)
 {
-#define SKIP_CHAR(c)                                                                               \
-    if (debug)                                                                                     \
-        qDebug() << "looking for " << c << " at " << QString(src.data() + i, n - i);               \
-    if (i >= n || src[i] != c) {                                                                   \
-        if (debug)                                                                                 \
-            qDebug() << " char '" << c << "' not found";                                           \
-        return false;                                                                              \
-    }                                                                                              \
-    ++i;
-
-#define SKIP_SPACE                                                                                 \
-    while (i < n && src[i] == ' ')                                                                 \
-        ++i;
-
-    qsizetype i = *pos;
-    qsizetype j {};
-
-    // assume "<@" has been parsed outside
-    // SKIP_CHAR('<');
-    // SKIP_CHAR('@');
-
-    if (tag != QStringView(src).mid(i, tag.length())) {
-        return false;
-    }
+    static const QLatin1String entities[] = {
+        QLatin1String("&quot;"), QLatin1String("\""),
+        QLatin1String("&gt;"),   QLatin1String(">"),
+        QLatin1String("&lt;"),   QLatin1String("<"),
+        QLatin1String("&amp;"),  QLatin1String("&")
+    };
 
-    if (debug)
-        qDebug() << "haystack:" << src << "needle:" << tag << "i:" << i;
-
-    // skip tag
-    i += tag.length();
-
-    // parse stuff like:  linkTag("(<@link node=\"([^\"]+)\">).*(</@link>)");
-    if (par1) {
-        SKIP_SPACE;
-        // read parameter name
-        j = i;
-        while (i < n && src[i].isLetter())
-            ++i;
-        if (src[i] == '=') {
-            if (debug)
-                qDebug() << "read parameter" << QString(src.data() + j, i - j);
-            SKIP_CHAR('=');
-            SKIP_CHAR('"');
-            // skip parameter name
-            j = i;
-            while (i < n && src[i] != '"')
-                ++i;
-            *par1 = QStringView(src).mid(j, i - j);
-            SKIP_CHAR('"');
-            SKIP_SPACE;
-        } else {
-            if (debug)
-                qDebug() << "no optional parameter found";
-        }
-    }
-    SKIP_SPACE;
-    SKIP_CHAR('>');
-
-    // find contents up to closing "</@tag>
-    j = i;
-    for (; true; ++i) {
-        if (i + 4 + tag.length() > n)
-            return false;
-        if (src[i] != '<')
-            continue;
-        if (src[i + 1] != '/')
-            continue;
-        if (src[i + 2] != '@')
-            continue;
-        if (tag != QStringView(src).mid(i + 3, tag.length()))
-            continue;
-        if (src[i + 3 + tag.length()] != '>')
+    QString t;
+    t.reserve(markedCode.size());
+    const MarkupTokens tokens = CodeMarker::tokenize(markedCode);
+    for (const MarkupToken &token : tokens) {
+        if (token.kind != MarkupToken::Text)
             continue;
-        break;
+        const QStringView text = token.text;
+        qsizetype start = 0;
+        for (qsizetype i = text.indexOf(QLatin1Char('&')); i >= 0;
+             i = text.indexOf(QLatin1Char('&'), i + 1)) {
+            for (int k = 0; k != 8; k += 2) {
+                if (text.sliced(i).startsWith(entities[k])) {
+                    t += text.sliced(start, i - start);
+                    t += entities[k + 1];
+                    start = i + entities[k].size();
+                    i = start - 1;
+                    break;
+                }
+            }
+        }
+        t += text.sliced(start);
     }
-
-    *contents = QStringView(src).mid(j, i - j);
-
-    i += tag.length() + 4;
-
-    *pos = i;
-    if (debug)
-        qDebug() << " tag " << tag << " found: pos now: " << i;
-    return true;
-#undef SKIP_CHAR
-}
-
-QString Generator::plainCode(const QString &markedCode)
-{
-    QString t = markedCode;
-    t.replace(tag, QString());
-    t.replace(quot, QLatin1String("\""));
-    t.replace(gt, QLatin1String(">"));
-    t.replace(lt, QLatin1String("<"));
-    t.replace(amp, QLatin1String("&"));
     return t;
 }
 
@@ -146,8 +146,6 @@ protected:
     QString indent(int level, const QString &markedCode);
     QTextStream &out();
     QString outFileName();
-    bool parseArg(const QString &src, const QString &tag, int *pos, int n, QStringView *contents,
-                  QStringView *par1 = nullptr, bool debug = false);
     void unknownAtom(const Atom *atom);
     int appendSortedQmlNames(Text &text, const Node *base, const NodeList &subs);
 
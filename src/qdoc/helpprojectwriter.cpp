@@ -19,9 +19,40 @@
 #include <QtCore/qcryptographichash.h>
 #include <QtCore/qdebug.h>
 #include <QtCore/qhash.h>
+#include <QtCore/qiodevice.h>
+#include <QtCore/qthreadpool.h>
 
 QT_BEGIN_NAMESPACE
 
+/*
+  Writes through to another device, and computes the SHA-1 hash of
+  everything written on the way. The device is opened in text mode,
+  so the hash is computed over the same bytes that end up in the file.
+ */
+class HashingDevice : public QIODevice
+{
+public:
+    explicit HashingDevice(QIODevice *target)
+        : m_target(target), m_hash(QCryptographicHash::Sha1)
+    {
+        open(QIODevice::WriteOnly | QIODevice::Text);
+    }
+
+    QByteArray result() const { return m_hash.result(); }
+
+protected:
+    qint64 readData(char *, qint64) override { return -1; }
+    qint64 writeData(const char *data, qint64 len) override
+    {
+        m_hash.addData(QByteArrayView(data, len));
+        return m_target->write(data, len);
+    }
+
+private:
+    QIODevice *m_target;
+    QCryptographicHash m_hash;
+};
+
 HelpProjectWriter::HelpProjectWriter(const QString &defaultFileName, Generator *g)
 {
     reset(defaultFileName, g);
@@ -197,73 +228,141 @@ Keyword HelpProjectWriter::keywordDetails(const Node *node) const
     }
 }
 
-bool HelpProjectWriter::generateSection(HelpProject &project, QXmlStreamWriter & /* writer */,
-                                        const Node *node)
+/*!
+  Collects what the help projects need to know about \a node into
+  \a records, and recurses into its children. Returns the index of the
+  record for \a node, or -1 if \a node is not part of any help project.
+
+  This is the only walk of the tree for all projects. Everything that
+  needs the generator, such as the keywords and their document locations,
+  is computed here once, so that the projects can then be assembled from
+  the records in parallel.
+ */
+qsizetype HelpProjectWriter::collectNode(QList<NodeRecord> &records,
+                                         QHash<const Node *, qsizetype> &recordIndex,
+                                         const Node *node)
 {
-    if (!node->url().isEmpty() && !(project.m_includeIndexNodes && !node->url().startsWith("http")))
-        return false;
-
+    /*
+      Don't include index nodes in the help file.
+     */
+    if (node->isIndexNode())
+        return -1;
     if (node->isPrivate() || node->isInternal() || node->isDontDocument())
-        return false;
+        return -1;
+
+    auto it = recordIndex.constFind(node);
+    if (it != recordIndex.constEnd())
+        return it.value();
+
+    NodeRecord record;
+    record.node = node;
+    record.nodeType = node->nodeType();
+    record.hasUrl = !node->url().isEmpty();
+    record.hasHttpUrl = node->url().startsWith("http");
+    record.named = !node->name().isEmpty();
+
+    if (record.named) {
+        record.docPath = node->doc().location().filePath();
+        record.objName = node->isTextPageNode() ? node->fullTitle() : node->fullDocumentName();
+        record.groupName = node->name().toLower();
+        record.isCollection = node->isCollectionNode();
+        if (record.isCollection) {
+            const auto members = static_cast<const CollectionNode *>(node)->members();
+            for (const Node *m : members) {
+                if (!m->isInAPI())
+                    continue;
+                QString memberName = m->isTextPageNode() ? m->fullTitle() : m->fullDocumentName();
+                record.members.append({ memberName, m });
+            }
+        }
+        record.listed = !node->isTextPageNode()
+                || !(node->isExternalPage() || node->fullTitle().isEmpty());
 
-    if (node->name().isEmpty())
-        return true;
+        addKeywords(record.keywords, node);
 
-    QString docPath = node->doc().location().filePath();
-    if (!docPath.isEmpty() && project.m_excluded.contains(docPath))
-        return false;
+        // Insert member status flags into the entries for the parent
+        // node of the function, or the node it is related to.
+        if (node->isFunction() && !node->isQmlNode() && !node->isJsNode())
+            record.statusParent = node->parent();
+
+        // Add all images referenced in the page to the set of files to include.
+        const Atom *atom = node->doc().body().firstAtom();
+        while (atom) {
+            if (atom->type() == Atom::Image || atom->type() == Atom::InlineImage) {
+                // Images are all placed within a single directory regardless of
+                // whether the source images are in a nested directory structure.
+                QStringList pieces = atom->string().split(QLatin1Char('/'));
+                record.files.append("images/" + pieces.last());
+            }
+            atom = atom->next();
+        }
+    }
 
-    QString objName = node->isTextPageNode() ? node->fullTitle() : node->fullDocumentName();
-    // Only add nodes to the set for each subproject if they match a selector.
-    // Those that match will be listed in the table of contents.
+    const qsizetype index = records.size();
+    records.append(record);
+    recordIndex.insert(node, index);
 
-    for (int i = 0; i < project.m_subprojects.length(); i++) {
-        SubProject subproject = project.m_subprojects[i];
-        // No selectors: accept all nodes.
-        if (subproject.m_selectors.isEmpty()) {
-            project.m_subprojects[i].m_nodes[objName] = node;
-        } else if (subproject.m_selectors.contains(node->nodeType())) {
-            // Add all group members for '[group|module|qmlmodule]:name' selector
-            if (node->isCollectionNode()) {
-                if (project.m_subprojects[i].m_groups.contains(node->name().toLower())) {
-                    const auto *cn = static_cast<const CollectionNode *>(node);
-                    const auto members = cn->members();
-                    for (const Node *m : members) {
-                        if (!m->isInAPI())
-                            continue;
-                        QString memberName =
-                                m->isTextPageNode() ? m->fullTitle() : m->fullDocumentName();
-                        project.m_subprojects[i].m_nodes[memberName] = m;
-                    }
-                    continue;
-                } else if (!project.m_subprojects[i].m_groups.isEmpty()) {
-                    continue; // Node does not represent specified group(s)
-                }
-            } else if (node->isTextPageNode()) {
-                if (node->isExternalPage() || node->fullTitle().isEmpty())
+    if (node->isAggregate()) {
+        const auto *aggregate = static_cast<const Aggregate *>(node);
+
+        // Ensure that we don't visit nodes more than once.
+        QSet<const Node *> childSet;
+        QList<const Node *> children;
+        HelpProject::NodeStatusSet childStatus;
+        const NodeList &childNodes = aggregate->childNodes();
+        for (const auto *child : childNodes) {
+            // Skip related non-members adopted by some other aggregate
+            if (child->parent() != aggregate)
+                continue;
+            if (child->isIndexNode() || child->isPrivate())
+                continue;
+            if (!child->isTextPageNode()) {
+                // Store member status of children
+                childStatus.insert(child->status());
+                if (child->isFunction() && static_cast<const FunctionNode *>(child)->isOverload())
                     continue;
             }
-            project.m_subprojects[i].m_nodes[objName] = node;
+            if (!childSet.contains(child)) {
+                childSet.insert(child);
+                children.append(child);
+            }
         }
+
+        QList<qsizetype> childIndexes;
+        for (const auto *child : qAsConst(children)) {
+            const qsizetype childIndex = collectNode(records, recordIndex, child);
+            if (childIndex >= 0)
+                childIndexes.append(childIndex);
+        }
+        records[index].childStatus = childStatus;
+        records[index].children = childIndexes;
     }
 
+    return index;
+}
+
+/*!
+  Appends the keywords for \a node to \a keywords.
+ */
+void HelpProjectWriter::addKeywords(QList<Keyword> &keywords, const Node *node) const
+{
     switch (node->nodeType()) {
 
     case Node::Class:
     case Node::Struct:
     case Node::Union:
-        project.m_keywords.append(keywordDetails(node));
+        keywords.append(keywordDetails(node));
         break;
     case Node::QmlType:
     case Node::QmlValueType:
     case Node::JsType:
     case Node::JsBasicType:
         if (node->doc().hasKeywords()) {
-            const auto keywords = node->doc().keywords();
-            for (const Atom *keyword : keywords) {
+            const auto docKeywords = node->doc().keywords();
+            for (const Atom *keyword : docKeywords) {
                 if (!keyword->string().isEmpty()) {
-                    project.m_keywords.append(Keyword(keyword->string(), keyword->string(),
-                                                      m_gen->fullDocumentLocation(node, false)));
+                    keywords.append(Keyword(keyword->string(), keyword->string(),
+                                            m_gen->fullDocumentLocation(node, false)));
                 }
                 else
                     node->doc().location().warning(
@@ -271,15 +370,15 @@ bool HelpProjectWriter::generateSection(HelpProject &project, QXmlStreamWriter &
                                     .arg(m_gen->fullDocumentLocation(node, false)));
             }
         }
-        project.m_keywords.append(keywordDetails(node));
+        keywords.append(keywordDetails(node));
         break;
 
     case Node::Namespace:
-        project.m_keywords.append(keywordDetails(node));
+        keywords.append(keywordDetails(node));
         break;
 
     case Node::Enum:
-        project.m_keywords.append(keywordDetails(node));
+        keywords.append(keywordDetails(node));
         {
             const auto *enumNode = static_cast<const EnumNode *>(node);
             const auto items = enumNode->items();
@@ -295,7 +394,7 @@ bool HelpProjectWriter::generateSection(HelpProject &project, QXmlStreamWriter &
                     name = id = item.name();
                 }
                 QString ref = m_gen->fullDocumentLocation(node, false);
-                project.m_keywords.append(Keyword(name, id, ref));
+                keywords.append(Keyword(name, id, ref));
             }
         }
         break;
@@ -307,10 +406,10 @@ bool HelpProjectWriter::generateSection(HelpProject &project, QXmlStreamWriter &
         const auto *cn = static_cast<const CollectionNode *>(node);
         if (!cn->fullTitle().isEmpty()) {
             if (cn->doc().hasKeywords()) {
-                const auto keywords = cn->doc().keywords();
-                for (const Atom *keyword : keywords) {
+                const auto docKeywords = cn->doc().keywords();
+                for (const Atom *keyword : docKeywords) {
                     if (!keyword->string().isEmpty()) {
-                        project.m_keywords.append(
+                        keywords.append(
                                 Keyword(keyword->string(), keyword->string(),
                                         m_gen->fullDocumentLocation(node, false)));
                     } else
@@ -319,14 +418,14 @@ bool HelpProjectWriter::generateSection(HelpProject &project, QXmlStreamWriter &
                                         .arg(m_gen->fullDocumentLocation(node, false)));
                 }
             }
-            project.m_keywords.append(keywordDetails(node));
+            keywords.append(keywordDetails(node));
         }
     } break;
 
     case Node::Property:
     case Node::QmlProperty:
     case Node::JsProperty:
-        project.m_keywords.append(keywordDetails(node));
+        keywords.append(keywordDetails(node));
         break;
 
     case Node::Function: {
@@ -340,23 +439,14 @@ bool HelpProjectWriter::generateSection(HelpProject &project, QXmlStreamWriter &
           because we already know it is NodeType::Function.
          */
         if (funcNode->isQmlNode() || funcNode->isJsNode()) {
-            project.m_keywords.append(keywordDetails(node));
+            keywords.append(keywordDetails(node));
             break;
         }
         // Only insert keywords for non-constructors. Constructors are covered
         // by the classes themselves.
 
         if (!funcNode->isSomeCtor())
-            project.m_keywords.append(keywordDetails(node));
-
-        // Insert member status flags into the entries for the parent
-        // node of the function, or the node it is related to.
-        // Since parent nodes should have already been inserted into
-        // the set of files, we only need to ensure that related nodes
-        // are inserted.
-
-        if (node->parent())
-            project.m_memberStatus[node->parent()].insert(node->status());
+            keywords.append(keywordDetails(node));
     } break;
     case Node::TypeAlias:
     case Node::Typedef: {
@@ -368,11 +458,11 @@ bool HelpProjectWriter::generateSection(HelpProject &project, QXmlStreamWriter &
         if (enumNode)
             typedefDetails.m_ref = m_gen->fullDocumentLocation(enumNode, false);
 
-        project.m_keywords.append(typedefDetails);
+        keywords.append(typedefDetails);
     } break;
 
     case Node::Variable: {
-        project.m_keywords.append(keywordDetails(node));
+        keywords.append(keywordDetails(node));
     } break;
 
         // Page nodes (such as manual pages) contain subtypes, titles and other
@@ -381,10 +471,10 @@ bool HelpProjectWriter::generateSection(HelpProject &project, QXmlStreamWriter &
         const auto *pn = static_cast<const PageNode *>(node);
         if (!pn->fullTitle().isEmpty()) {
             if (pn->doc().hasKeywords()) {
-                const auto keywords = pn->doc().keywords();
-                for (const Atom *keyword : keywords) {
+                const auto docKeywords = pn->doc().keywords();
+                for (const Atom *keyword : docKeywords) {
                     if (!keyword->string().isEmpty()) {
-                        project.m_keywords.append(
+                        keywords.append(
                                 Keyword(keyword->string(), keyword->string(),
                                         m_gen->fullDocumentLocation(node, false)));
                     } else {
@@ -393,82 +483,126 @@ bool HelpProjectWriter::generateSection(HelpProject &project, QXmlStreamWriter &
                     }
                 }
             }
-            project.m_keywords.append(keywordDetails(node));
+            keywords.append(keywordDetails(node));
         }
         break;
     }
     default:;
     }
-
-    // Add all images referenced in the page to the set of files to include.
-    const Atom *atom = node->doc().body().firstAtom();
-    while (atom) {
-        if (atom->type() == Atom::Image || atom->type() == Atom::InlineImage) {
-            // Images are all placed within a single directory regardless of
-            // whether the source images are in a nested directory structure.
-            QStringList pieces = atom->string().split(QLatin1Char('/'));
-            project.m_files.insert("images/" + pieces.last());
-        }
-        atom = atom->next();
-    }
-
-    return true;
 }
 
-void HelpProjectWriter::generateSections(HelpProject &project, QXmlStreamWriter &writer,
-                                         const Node *node)
+/*!
+  Adds the node of the record at \a index in \a records and, recursively,
+  its children to \a project, unless the settings of \a project exclude
+  them. Only reads \a records, so that this can run for several projects
+  at the same time.
+ */
+void HelpProjectWriter::collectProject(HelpProject &project, const QList<NodeRecord> &records,
+                                       qsizetype index)
 {
-    /*
-      Don't include index nodes in the help file.
-     */
-    if (node->isIndexNode())
-        return;
-    if (!generateSection(project, writer, node))
+    const NodeRecord &record = records.at(index);
+    if (record.hasUrl && !(project.m_includeIndexNodes && !record.hasHttpUrl))
         return;
 
-    if (node->isAggregate()) {
-        const auto *aggregate = static_cast<const Aggregate *>(node);
-
-        // Ensure that we don't visit nodes more than once.
-        QSet<const Node *> childSet;
-        const NodeList &children = aggregate->childNodes();
-        for (const auto *child : children) {
-            // Skip related non-members adopted by some other aggregate
-            if (child->parent() != aggregate)
-                continue;
-            if (child->isIndexNode() || child->isPrivate())
-                continue;
-            if (child->isTextPageNode()) {
-                childSet << child;
-            } else {
-                // Store member status of children
-                project.m_memberStatus[node].insert(child->status());
-                if (child->isFunction() && static_cast<const FunctionNode *>(child)->isOverload())
+    if (record.named) {
+        if (!record.docPath.isEmpty() && project.m_excluded.contains(record.docPath))
+            return;
+
+        // Only add nodes to the set for each subproject if they match a selector.
+        // Those that match will be listed in the table of contents.
+        for (SubProject &subproject : project.m_subprojects) {
+            // No selectors: accept all nodes.
+            if (subproject.m_selectors.isEmpty()) {
+                subproject.m_nodes[record.objName] = record.node;
+            } else if (subproject.m_selectors.contains(record.nodeType)) {
+                // Add all group members for '[group|module|qmlmodule]:name' selector
+                if (record.isCollection) {
+                    if (subproject.m_groups.contains(record.groupName)) {
+                        for (const auto &member : record.members)
+                            subproject.m_nodes[member.first] = member.second;
+                        continue;
+                    } else if (!subproject.m_groups.isEmpty()) {
+                        continue; // Node does not represent specified group(s)
+                    }
+                } else if (!record.listed) {
                     continue;
-                childSet << child;
+                }
+                subproject.m_nodes[record.objName] = record.node;
             }
         }
-        for (const auto *child : qAsConst(childSet))
-            generateSections(project, writer, child);
+
+        project.m_keywords.append(record.keywords);
+        for (const QString &file : record.files)
+            project.m_files.insert(file);
+        if (record.statusParent)
+            project.m_memberStatus[record.statusParent].insert(record.node->status());
     }
+
+    if (!record.childStatus.isEmpty())
+        project.m_memberStatus[record.node].unite(record.childStatus);
+    for (qsizetype child : record.children)
+        collectProject(project, records, child);
 }
 
+/*!
+  Generates the help projects.
+
+  The tree is walked once for all projects. The keywords, files and
+  table of contents entries of each project are then assembled and
+  sorted on a thread pool, and the project files are written last.
+ */
 void HelpProjectWriter::generate()
 {
-    for (HelpProject &project : m_projects)
-        generateProject(project);
+    // Restrict searching only to the local (primary) tree
+    QList<Tree *> searchOrder = m_qdb->searchOrder();
+    m_qdb->setLocalSearch();
+
+    QList<NodeRecord> records;
+    QHash<const Node *, qsizetype> recordIndex;
+    QList<const Node *> rootNodes;
+    QList<qsizetype> rootIndexes;
+    for (const HelpProject &project : qAsConst(m_projects)) {
+        const Node *rootNode;
+        if (!project.m_indexRoot.isEmpty())
+            rootNode = m_qdb->findPageNodeByTitle(project.m_indexRoot);
+        else
+            rootNode = m_qdb->primaryTreeRoot();
+        rootNodes.append(rootNode);
+        rootIndexes.append(rootNode ? collectNode(records, recordIndex, rootNode) : -1);
+    }
+
+    QThreadPool pool;
+    for (qsizetype i = 0; i < m_projects.size(); ++i) {
+        if (!rootNodes.at(i))
+            continue;
+        HelpProject *project = &m_projects[i];
+        project->m_files.clear();
+        project->m_keywords.clear();
+        const qsizetype rootIndex = rootIndexes.at(i);
+        pool.start([project, &records, rootIndex] {
+            if (rootIndex >= 0)
+                collectProject(*project, records, rootIndex);
+            std::sort(project->m_keywords.begin(), project->m_keywords.end());
+        });
+    }
+    pool.waitForDone();
+
+    for (qsizetype i = 0; i < m_projects.size(); ++i) {
+        if (rootNodes.at(i))
+            generateProject(m_projects[i], rootNodes.at(i));
+    }
+
+    // Restore original search order
+    m_qdb->setSearchOrder(searchOrder);
 }
 
-void HelpProjectWriter::writeHashFile(QFile &file)
+void HelpProjectWriter::writeHashFile(const QString &fileName, const QByteArray &hash)
 {
-    QCryptographicHash hash(QCryptographicHash::Sha1);
-    hash.addData(&file);
-
-    QFile hashFile(file.fileName() + ".sha1");
+    QFile hashFile(fileName + ".sha1");
     if (!hashFile.open(QFile::WriteOnly | QFile::Text))
         return;
 
-    hashFile.write(hash.result().toHex());
+    hashFile.write(hash.toHex());
     hashFile.close();
 }
 
@@ -564,30 +698,19 @@ void HelpProjectWriter::writeNode(HelpProject &project, QXmlStreamWriter &writer
     }
 }
 
-void HelpProjectWriter::generateProject(HelpProject &project)
+/*!
+  Writes the help project file for \a project, whose keywords, files and
+  table of contents entries have been collected from \a rootNode, and the
+  SHA-1 hash of the file.
+ */
+void HelpProjectWriter::generateProject(HelpProject &project, const Node *rootNode)
 {
-    const Node *rootNode;
-
-    // Restrict searching only to the local (primary) tree
-    QList<Tree *> searchOrder = m_qdb->searchOrder();
-    m_qdb->setLocalSearch();
-
-    if (!project.m_indexRoot.isEmpty())
-        rootNode = m_qdb->findPageNodeByTitle(project.m_indexRoot);
-    else
-        rootNode = m_qdb->primaryTreeRoot();
-
-    if (rootNode == nullptr)
-        return;
-
-    project.m_files.clear();
-    project.m_keywords.clear();
-
     QFile file(m_outputDir + QDir::separator() + project.m_fileName);
-    if (!file.open(QFile::WriteOnly | QFile::Text))
+    if (!file.open(QFile::WriteOnly))
         return;
 
-    QXmlStreamWriter writer(&file);
+    HashingDevice device(&file);
+    QXmlStreamWriter writer(&device);
     writer.setAutoFormatting(true);
     writer.writeStartDocument();
     writer.writeStartElement("QtHelpProject");
@@ -637,8 +760,6 @@ void HelpProjectWriter::generateProject(HelpProject &project)
     writer.writeAttribute("ref", indexPath);
     writer.writeAttribute("title", project.m_indexTitle);
 
-    generateSections(project, writer, rootNode);
-
     for (int i = 0; i < project.m_subprojects.length(); i++) {
         SubProject subproject = project.m_subprojects[i];
 
@@ -746,14 +867,10 @@ void HelpProjectWriter::generateProject(HelpProject &project)
         }
     }
 
-    // Restore original search order
-    m_qdb->setSearchOrder(searchOrder);
-
     writer.writeEndElement(); // section
     writer.writeEndElement(); // toc
 
     writer.writeStartElement("keywords");
-    std::sort(project.m_keywords.begin(), project.m_keywords.end());
     for (const auto &k : qAsConst(project.m_keywords)) {
         for (const auto &id : qAsConst(k.m_ids)) {
             writer.writeStartElement("keyword");
@@ -784,8 +901,8 @@ void HelpProjectWriter::generateProject(HelpProject &project)
     writer.writeEndElement(); // filterSection
     writer.writeEndElement(); // QtHelpProject
     writer.writeEndDocument();
-    writeHashFile(file);
     file.close();
+    writeHashFile(file.fileName(), device.result());
 }
 
 QT_END_NAMESPACE
@@ -6,6 +6,8 @@
 
 #include "node.h"
 
+#include <QtCore/qhash.h>
+#include <QtCore/qlist.h>
 #include <QtCore/qstring.h>
 #include <QtCore/qxmlstream.h>
 
@@ -85,11 +87,38 @@ public:
     void generate();
 
 private:
-    void generateProject(HelpProject &project);
-    void generateSections(HelpProject &project, QXmlStreamWriter &writer, const Node *node);
-    bool generateSection(HelpProject &project, QXmlStreamWriter &writer, const Node *node);
+    /*
+     * What the help projects need to know about a node, collected in
+     * a single walk of the tree that is shared by all projects.
+     */
+    struct NodeRecord
+    {
+        const Node *node {};
+        QString objName {};
+        QString docPath {};
+        QString groupName {};
+        unsigned char nodeType {};
+        bool named {};
+        bool hasUrl {};
+        bool hasHttpUrl {};
+        bool isCollection {};
+        bool listed {};
+        QList<std::pair<QString, const Node *>> members {};
+        QList<Keyword> keywords {};
+        QStringList files {};
+        const Node *statusParent {};
+        HelpProject::NodeStatusSet childStatus {};
+        QList<qsizetype> children {};
+    };
+
+    qsizetype collectNode(QList<NodeRecord> &records, QHash<const Node *, qsizetype> &recordIndex,
+                          const Node *node);
+    void addKeywords(QList<Keyword> &keywords, const Node *node) const;
+    static void collectProject(HelpProject &project, const QList<NodeRecord> &records,
+                               qsizetype index);
+    void generateProject(HelpProject &project, const Node *rootNode);
     Keyword keywordDetails(const Node *node) const;
-    void writeHashFile(QFile &file);
+    void writeHashFile(const QString &fileName, const QByteArray &hash);
     void writeNode(HelpProject &project, QXmlStreamWriter &writer, const Node *node);
     void readSelectors(SubProject &subproject, const QStringList &selectors);
     void addMembers(HelpProject &project, QXmlStreamWriter &writer, const Node *node);
@@ -415,7 +415,7 @@ qsizetype HtmlGenerator::generateAtom(const Atom *atom, const Node *relative, Co
             out() << formattingLeftMap()[atom->string()];
         if (atom->string() == ATOM_FORMATTING_PARAMETER) {
             if (atom->next() != nullptr && atom->next()->type() == Atom::String) {
-                QRegularExpression subscriptRegExp("^([a-z]+)_([0-9n])$");
+                static const QRegularExpression subscriptRegExp("^([a-z]+)_([0-9n])$");
                 auto match = subscriptRegExp.match(atom->next()->string());
                 if (match.hasMatch()) {
                     out() << match.captured(1) << "<sub>" << match.captured(2)
@@ -2860,30 +2860,11 @@ void HtmlGenerator::generateLegaleseList(const Node *relative, CodeMarker *marke
 void HtmlGenerator::generateQmlItem(const Node *node, const Node *relative, CodeMarker *marker,
                                     bool summary)
 {
-    QString marked = marker->markedUpQmlItem(node, summary);
-    QRegularExpression templateTag("(<[^@>]*>)");
-    auto match = templateTag.match(marked);
-    if (match.hasMatch()) {
-        QString contents = protectEnc(match.captured(1));
-        marked.replace(match.capturedStart(1), match.capturedLength(1), contents);
-    }
-
-    // Look for the _ character in the member name followed by a number (or n):
-    // this is intended to be rendered as a subscript.
-    marked.replace(QRegularExpression("<@param>([a-z]+)_([0-9]+|n)</@param>"), "<i>\\1<sub>\\2</sub></i>");
-    // Replace some markup by HTML tags. Do both the opening and the closing tag
-    // in one go (instead of <@param> and </@param> separately, for instance).
-    marked.replace("@param>", "i>");
-
-    marked.replace("@extra>", "code>");
-
-    if (summary) {
-        marked.remove("<@name>");
-        marked.remove("</@name>");
-        marked.remove("<@type>");
-        marked.remove("</@type>");
-    }
-    out() << highlightedCode(marked, relative, false, Node::QML);
+    const QString marked = marker->markedUpQmlItem(node, summary);
+    QStringList storage;
+    const MarkupTokens tokens =
+            rewriteSynopsis(CodeMarker::tokenize(marked), true, false, summary, summary, &storage);
+    out() << highlightedCode(tokens, relative, false, Node::QML);
 }
 
 /*!
@@ -3107,181 +3088,288 @@ void HtmlGenerator::generateSynopsis(const Node *node, const Node *relative, Cod
 
     if (prefix)
         marked.prepend(*prefix);
-    QRegularExpression templateTag("(<[^@>]*>)");
-    auto match = templateTag.match(marked);
-    if (match.hasMatch()) {
-        QString contents = protectEnc(match.captured(1));
-        marked.replace(match.capturedStart(1), match.capturedLength(1), contents);
-    }
 
-    marked.replace(QRegularExpression("<@param>([a-z]+)_([1-9n])</@param>"), "<i>\\1<sub>\\2</sub></i>");
-    marked.replace("<@param>", "<i>");
-    marked.replace("</@param>", "</i>");
+    QStringList storage;
+    const MarkupTokens tokens = rewriteSynopsis(CodeMarker::tokenize(marked), false,
+                                                style == Section::AllMembers,
+                                                style == Section::Summary,
+                                                style != Section::Details, &storage);
+    out() << highlightedCode(tokens, relative, alignNames);
+}
 
-    if (style == Section::Summary) {
-        marked.remove("<@name>"); // was "<b>"
-        marked.remove("</@name>"); // was "</b>"
+/*!
+  Returns the part of \a text that the regular expression
+  \c{<[^@>]*>} would match, the first template parameter
+  list in a synopsis, or an empty view.
+ */
+static QStringView findTemplateTag(QStringView text)
+{
+    for (qsizetype i = text.indexOf(QLatin1Char('<')); i >= 0;
+         i = text.indexOf(QLatin1Char('<'), i + 1)) {
+        for (qsizetype j = i + 1; j < text.size(); ++j) {
+            if (text.at(j) == QLatin1Char('>'))
+                return text.sliced(i, j + 1 - i);
+            if (text.at(j) == QLatin1Char('@'))
+                break;
+        }
     }
+    return QStringView();
+}
 
-    if (style == Section::AllMembers) {
-        QRegularExpression extraRegExp("<@extra>.*</@extra>", QRegularExpression::InvertedGreedinessOption);
-        marked.remove(extraRegExp);
-    } else {
-        marked.replace("<@extra>", "<code>");
-        marked.replace("</@extra>", "</code>");
+/*!
+  Returns true if \a name is a parameter name like \c{a_1} or \c{a_n}
+  that should be rendered with a subscript, and splits it into the
+  \a base and the \a subscript. Unless \a multiDigit is true, only the
+  digits 1 to 9 and \c{n} are accepted as subscripts.
+ */
+static bool splitSubscript(QStringView name, bool multiDigit, QStringView *base,
+                           QStringView *subscript)
+{
+    const qsizetype underscore = name.indexOf(QLatin1Char('_'));
+    if (underscore < 1 || underscore + 1 == name.size())
+        return false;
+    for (QChar c : name.first(underscore)) {
+        if (c < QLatin1Char('a') || c > QLatin1Char('z'))
+            return false;
     }
-
-    if (style != Section::Details) {
-        marked.remove("<@type>");
-        marked.remove("</@type>");
+    const QStringView sub = name.sliced(underscore + 1);
+    if (sub != QLatin1String("n")) {
+        if (!multiDigit && sub.size() != 1)
+            return false;
+        for (QChar c : sub) {
+            if (c < QLatin1Char(multiDigit ? '0' : '1') || c > QLatin1Char('9'))
+                return false;
+        }
     }
+    *base = name.first(underscore);
+    *subscript = sub;
+    return true;
+}
 
-    out() << highlightedCode(marked, relative, alignNames);
+/*!
+  Rewrites the \a tokens of a synopsis for HTML:
+
+  \list
+    \li The first template parameter list in the text is escaped.
+    \li \c{<@param>} becomes \c{<i>}, with a subscript for names like
+        \c{a_1}. \a qmlItem selects the names accepted by QML items.
+    \li \c{<@extra>} becomes \c{<code>}, or is dropped along with its
+        contents if \a dropExtra is true.
+    \li The \c{<@name>} and \c{<@type>} tags are dropped if \a dropNames
+        and \a dropTypes are true, respectively.
+  \endlist
+
+  Escaped text is kept in \a storage, which must outlive the returned tokens.
+ */
+MarkupTokens HtmlGenerator::rewriteSynopsis(const MarkupTokens &tokens, bool qmlItem,
+                                            bool dropExtra, bool dropNames, bool dropTypes,
+                                            QStringList *storage)
+{
+    static const QString italic = QStringLiteral("<i>");
+    static const QString endItalic = QStringLiteral("</i>");
+    static const QString subscript = QStringLiteral("<sub>");
+    static const QString endSubscriptItalic = QStringLiteral("</sub></i>");
+    static const QString code = QStringLiteral("<code>");
+    static const QString endCode = QStringLiteral("</code>");
+    const QLatin1String paramTag("param");
+    const QLatin1String extraTag("extra");
+
+    MarkupTokens result;
+    result.reserve(tokens.size() + 2);
+    bool templateTagDone = false;
+    for (qsizetype i = 0; i < tokens.size(); ++i) {
+        const MarkupToken &token = tokens.at(i);
+        if (token.kind == MarkupToken::Text) {
+            const QStringView templateTag = templateTagDone ? QStringView()
+                                                            : findTemplateTag(token.text);
+            if (templateTag.isEmpty()) {
+                result.append(token);
+                continue;
+            }
+            templateTagDone = true;
+            const qsizetype start = templateTag.data() - token.text.data();
+            storage->append(protectEnc(templateTag.toString()));
+            if (start > 0)
+                result.append({ MarkupToken::Text, token.text.first(start) });
+            result.append({ MarkupToken::Text, storage->constLast() });
+            if (start + templateTag.size() < token.text.size())
+                result.append({ MarkupToken::Text, token.text.sliced(start + templateTag.size()) });
+        } else if (token.isPlainTag(paramTag)) {
+            QStringView base;
+            QStringView sub;
+            if (token.kind == MarkupToken::OpenTag && i + 2 < tokens.size()
+                && tokens.at(i + 1).kind == MarkupToken::Text
+                && tokens.at(i + 2).kind == MarkupToken::CloseTag
+                && tokens.at(i + 2).isPlainTag(paramTag)
+                && splitSubscript(tokens.at(i + 1).text, qmlItem, &base, &sub)) {
+                result.append({ MarkupToken::Text, italic });
+                result.append({ MarkupToken::Text, base });
+                result.append({ MarkupToken::Text, subscript });
+                result.append({ MarkupToken::Text, sub });
+                result.append({ MarkupToken::Text, endSubscriptItalic });
+                i += 2;
+            } else {
+                result.append({ MarkupToken::Text,
+                                token.kind == MarkupToken::OpenTag ? italic : endItalic });
+            }
+        } else if (token.isPlainTag(extraTag)) {
+            if (!dropExtra) {
+                result.append({ MarkupToken::Text,
+                                token.kind == MarkupToken::OpenTag ? code : endCode });
+                continue;
+            }
+            if (token.kind == MarkupToken::CloseTag)
+                continue;
+            qsizetype close = i + 1;
+            while (close < tokens.size() && !(tokens.at(close).kind == MarkupToken::CloseTag
+                                              && tokens.at(close).isPlainTag(extraTag))) {
+                ++close;
+            }
+            if (close < tokens.size())
+                i = close;
+            else
+                result.append(token);
+        } else if (!(dropNames && token.isPlainTag(QLatin1String("name")))
+                   && !(dropTypes && token.isPlainTag(QLatin1String("type")))) {
+            result.append(token);
+        }
+    }
+    return result;
 }
 
 QString HtmlGenerator::highlightedCode(const QString &markedCode, const Node *relative,
                                        bool alignNames, Node::Genus genus)
 {
-    QString src = markedCode;
-    QString html;
-    html.reserve(src.size());
-    QStringView arg;
-    QStringView par1;
+    return highlightedCode(CodeMarker::tokenize(markedCode), relative, alignNames, genus);
+}
 
-    const QChar charLangle = '<';
-    const QChar charAt = '@';
+/*!
+  Appends the \a tokens from \a from up to \a to to \a html, turning the
+  syntax highlighting tags into spans and dropping all other tags.
+ */
+static void appendHighlighted(const MarkupTokens &tokens, qsizetype from, qsizetype to,
+                              QString *html)
+{
+    static const QLatin1String spanTags[] = {
+        QLatin1String("comment"),      QLatin1String("<span class=\"comment\">"),
+        QLatin1String("preprocessor"), QLatin1String("<span class=\"preprocessor\">"),
+        QLatin1String("string"),       QLatin1String("<span class=\"string\">"),
+        QLatin1String("char"),         QLatin1String("<span class=\"char\">"),
+        QLatin1String("number"),       QLatin1String("<span class=\"number\">"),
+        QLatin1String("op"),           QLatin1String("<span class=\"operator\">"),
+        QLatin1String("type"),         QLatin1String("<span class=\"type\">"),
+        QLatin1String("name"),         QLatin1String("<span class=\"name\">"),
+        QLatin1String("keyword"),      QLatin1String("<span class=\"keyword\">")
+    };
 
-    static const QString typeTag("type");
-    static const QString headerTag("headerfile");
-    static const QString funcTag("func");
-    static const QString linkTag("link");
+    for (qsizetype i = from; i < to; ++i) {
+        const MarkupToken &token = tokens.at(i);
+        if (token.kind == MarkupToken::Text) {
+            *html += token.text;
+            continue;
+        }
+        for (int k = 0; k != 18; k += 2) {
+            if (token.isPlainTag(spanTags[k])) {
+                if (token.kind == MarkupToken::OpenTag)
+                    *html += spanTags[k + 1];
+                else
+                    *html += QLatin1String("</span>");
+                break;
+            }
+        }
+    }
+}
+
+/*!
+  Returns the code marked up by the \a tokens from \a from up to \a to.
+ */
+static QString markedUpText(const MarkupTokens &tokens, qsizetype from, qsizetype to)
+{
+    QString text;
+    for (qsizetype i = from; i < to; ++i)
+        text += tokens.at(i).text;
+    return text;
+}
+
+QString HtmlGenerator::highlightedCode(const MarkupTokens &tokens, const Node *relative,
+                                       bool alignNames, Node::Genus genus)
+{
+    QString html;
+    const QLatin1String typeTag("type");
+    const QLatin1String headerTag("headerfile");
+    const QLatin1String funcTag("func");
+    const QLatin1String linkTag("link");
 
-    // replace all <@link> tags: "(<@link node=\"([^\"]+)\">).*(</@link>)"
-    // replace all <@func> tags: "(<@func target=\"([^\"]*)\">)(.*)(</@func>)"
-    // replace all "(<@(type|headerfile)(?: +[^>]*)?>)(.*)(</@\\2>)" tags
+    // <@link>, <@func>, <@type> and <@headerfile> become links, and all
+    // other tags are handled by appendHighlighted()
     bool done = false;
-    for (int i = 0, srcSize = src.size(); i < srcSize;) {
-        if (src.at(i) == charLangle && src.at(i + 1) == charAt) {
-            if (alignNames && !done) {
-                html += QLatin1String("</td><td class=\"memItemRight bottomAlign\">");
-                done = true;
+    for (qsizetype i = 0; i < tokens.size(); ++i) {
+        const MarkupToken &token = tokens.at(i);
+        if (token.kind != MarkupToken::OpenTag) {
+            appendHighlighted(tokens, i, i + 1, &html);
+            continue;
+        }
+
+        if (alignNames && !done) {
+            html += QLatin1String("</td><td class=\"memItemRight bottomAlign\">");
+            done = true;
+        }
+
+        // The contents reach up to the first closing tag, nesting is not supported
+        qsizetype close = -1;
+        for (const QLatin1String &tag : { linkTag, funcTag, typeTag, headerTag }) {
+            if (token.name != tag)
+                continue;
+            for (qsizetype j = i + 1; j < tokens.size(); ++j) {
+                if (tokens.at(j).kind == MarkupToken::CloseTag && tokens.at(j).isPlainTag(tag)) {
+                    close = j;
+                    break;
+                }
             }
-            i += 2;
-            if (parseArg(src, linkTag, &i, srcSize, &arg, &par1)) {
-                html += QLatin1String("<b>");
-                const Node *n = CodeMarker::nodeForString(par1.toString());
-                QString link = linkForNode(n, relative);
-                addLink(link, arg, &html);
-                html += QLatin1String("</b>");
-            } else if (parseArg(src, funcTag, &i, srcSize, &arg, &par1)) {
-                const FunctionNode *fn = m_qdb->findFunctionNode(par1.toString(), relative, genus);
-                QString link = linkForNode(fn, relative);
-                addLink(link, arg, &html);
-                par1 = QStringView();
-            } else if (parseArg(src, typeTag, &i, srcSize, &arg, &par1)) {
-                par1 = QStringView();
-                const Node *n = m_qdb->findTypeNode(arg.toString(), relative, genus);
-                html += QLatin1String("<span class=\"type\">");
-                if (n && (n->isQmlBasicType() || n->isJsBasicType())) {
-                    if (relative && (relative->genus() == n->genus() || genus == n->genus()))
-                        addLink(linkForNode(n, relative), arg, &html);
-                    else
-                        html += arg;
-                } else
+            break;
+        }
+        if (close < 0) {
+            appendHighlighted(tokens, i, i + 1, &html);
+            continue;
+        }
+
+        QString arg;
+        appendHighlighted(tokens, i + 1, close, &arg);
+        if (token.name == linkTag) {
+            html += QLatin1String("<b>");
+            const Node *n = CodeMarker::nodeForString(token.target.toString());
+            QString link = linkForNode(n, relative);
+            addLink(link, arg, &html);
+            html += QLatin1String("</b>");
+        } else if (token.name == funcTag) {
+            const FunctionNode *fn =
+                    m_qdb->findFunctionNode(token.target.toString(), relative, genus);
+            QString link = linkForNode(fn, relative);
+            addLink(link, arg, &html);
+        } else if (token.name == typeTag) {
+            const Node *n = m_qdb->findTypeNode(markedUpText(tokens, i + 1, close), relative, genus);
+            html += QLatin1String("<span class=\"type\">");
+            if (n && (n->isQmlBasicType() || n->isJsBasicType())) {
+                if (relative && (relative->genus() == n->genus() || genus == n->genus()))
                     addLink(linkForNode(n, relative), arg, &html);
-                html += QLatin1String("</span>");
-            } else if (parseArg(src, headerTag, &i, srcSize, &arg, &par1)) {
-                par1 = QStringView();
-                if (arg.startsWith(QLatin1Char('&')))
+                else
                     html += arg;
-                else {
-                    const Node *n = m_qdb->findNodeForInclude(QStringList(arg.toString()));
-                    if (n && n != relative)
-                        addLink(linkForNode(n, relative), arg, &html);
-                    else
-                        html += arg;
-                }
-            } else {
-                html += charLangle;
-                html += charAt;
-            }
+            } else
+                addLink(linkForNode(n, relative), arg, &html);
+            html += QLatin1String("</span>");
         } else {
-            html += src.at(i++);
-        }
-    }
-
-    // replace all
-    // "<@comment>" -> "<span class=\"comment\">";
-    // "<@preprocessor>" -> "<span class=\"preprocessor\">";
-    // "<@string>" -> "<span class=\"string\">";
-    // "<@char>" -> "<span class=\"char\">";
-    // "<@number>" -> "<span class=\"number\">";
-    // "<@op>" -> "<span class=\"operator\">";
-    // "<@type>" -> "<span class=\"type\">";
-    // "<@name>" -> "<span class=\"name\">";
-    // "<@keyword>" -> "<span class=\"keyword\">";
-    // "</@(?:comment|preprocessor|string|char|number|op|type|name|keyword)>" -> "</span>"
-    src = html;
-    html = QString();
-    html.reserve(src.size());
-    static const QLatin1String spanTags[] = {
-        QLatin1String("comment>"),      QLatin1String("<span class=\"comment\">"),
-        QLatin1String("preprocessor>"), QLatin1String("<span class=\"preprocessor\">"),
-        QLatin1String("string>"),       QLatin1String("<span class=\"string\">"),
-        QLatin1String("char>"),         QLatin1String("<span class=\"char\">"),
-        QLatin1String("number>"),       QLatin1String("<span class=\"number\">"),
-        QLatin1String("op>"),           QLatin1String("<span class=\"operator\">"),
-        QLatin1String("type>"),         QLatin1String("<span class=\"type\">"),
-        QLatin1String("name>"),         QLatin1String("<span class=\"name\">"),
-        QLatin1String("keyword>"),      QLatin1String("<span class=\"keyword\">")
-    };
-    int nTags = 9;
-    // Update the upper bound of k in the following code to match the length
-    // of the above array.
-    for (int i = 0, n = src.size(); i < n;) {
-        if (src.at(i) == QLatin1Char('<')) {
-            if (src.at(i + 1) == QLatin1Char('@')) {
-                i += 2;
-                bool handled = false;
-                for (int k = 0; k != nTags; ++k) {
-                    const QLatin1String &tag = spanTags[2 * k];
-                    if (i + tag.size() <= src.length() && tag == QStringView(src).mid(i, tag.size())) {
-                        html += spanTags[2 * k + 1];
-                        i += tag.size();
-                        handled = true;
-                        break;
-                    }
-                }
-                if (!handled) {
-                    // drop 'our' unknown tags (the ones still containing '@')
-                    while (i < n && src.at(i) != QLatin1Char('>'))
-                        ++i;
-                    ++i;
-                }
-                continue;
-            } else if (src.at(i + 1) == QLatin1Char('/') && src.at(i + 2) == QLatin1Char('@')) {
-                i += 3;
-                bool handled = false;
-                for (int k = 0; k != nTags; ++k) {
-                    const QLatin1String &tag = spanTags[2 * k];
-                    if (i + tag.size() <= src.length() && tag == QStringView(src).mid(i, tag.size())) {
-                        html += QLatin1String("</span>");
-                        i += tag.size();
-                        handled = true;
-                        break;
-                    }
-                }
-                if (!handled) {
-                    // drop 'our' unknown tags (the ones still containing '@')
-                    while (i < n && src.at(i) != QLatin1Char('>'))
-                        ++i;
-                    ++i;
-                }
-                continue;
+            const QString header = markedUpText(tokens, i + 1, close);
+            if (header.startsWith(QLatin1Char('&'))) {
+                html += arg;
+            } else {
+                const Node *n = m_qdb->findNodeForInclude(QStringList(header));
+                if (n && n != relative)
+                    addLink(linkForNode(n, relative), arg, &html);
+                else
+                    html += arg;
             }
         }
-        html += src.at(i);
-        ++i;
+        i = close;
     }
     return html;
 }
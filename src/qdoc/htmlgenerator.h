@@ -91,6 +91,10 @@ private:
     void generateSectionInheritedList(const Section &section, const Node *relative);
     QString highlightedCode(const QString &markedCode, const Node *relative,
                             bool alignNames = false, Node::Genus genus = Node::DontCare);
+    QString highlightedCode(const MarkupTokens &tokens, const Node *relative,
+                            bool alignNames = false, Node::Genus genus = Node::DontCare);
+    MarkupTokens rewriteSynopsis(const MarkupTokens &tokens, bool qmlItem, bool dropExtra,
+                                 bool dropNames, bool dropTypes, QStringList *storage);
 
     void generateFullName(const Node *apparentNode, const Node *relative,
                           const Node *actualNode = nullptr);
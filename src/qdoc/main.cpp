@@ -565,6 +565,7 @@ static void processQdocconfFile(const QString &fileName)
       one.
      */
     qCDebug(lcQdoc, "Generating docs");
+    qdb->setLinkCacheEnabled(true);
     for (const auto &format : outputFormats) {
         auto *generator = Generator::generatorForFormat(format);
         if (generator == nullptr)
@@ -573,6 +574,9 @@ static void processQdocconfFile(const QString &fileName)
         generator->initializeFormat();
         generator->generateDocs();
     }
+    qdb->setLinkCacheEnabled(false);
+    qCDebug(lcQdoc, "Link resolution cache: %lld hits, %lld misses",
+            qdb->linkCacheHits(), qdb->linkCacheMisses());
 
     qCDebug(lcQdoc, "Terminating qdoc classes");
     if (Utilities::debugging())
@@ -160,8 +160,19 @@ void ManifestWriter::processManifestMetaContent(const QString &fullName, F match
  */
 void ManifestWriter::generateManifestFiles()
 {
-    generateManifestFile("examples", "example");
-    generateManifestFile("demos", "demo");
+    // Split the examples from the demos in one pass over the example nodes
+    QList<const ExampleNode *> examples;
+    QList<const ExampleNode *> demos;
+    const ExampleNodeMap &exampleNodeMap = m_qdb->exampleNodeMap();
+    for (const ExampleNode *example : exampleNodeMap) {
+        if (example->name().startsWith("demos"))
+            demos.append(example);
+        else
+            examples.append(example);
+    }
+
+    generateManifestFile("examples", "example", examples);
+    generateManifestFile("demos", "demo", demos);
     m_qdb->exampleNodeMap().clear();
     m_manifestMetaContent.clear();
 }
@@ -169,19 +180,13 @@ void ManifestWriter::generateManifestFiles()
 /*!
   This function is called by generateManifestFiles(), once
   for each manifest file to be generated. \a manifest is the
-  type of manifest file.
+  type of manifest file, and \a examples are the example nodes
+  to list in it, in the order they are written.
  */
-void ManifestWriter::generateManifestFile(const QString &manifest, const QString &element)
+void ManifestWriter::generateManifestFile(const QString &manifest, const QString &element,
+                                          const QList<const ExampleNode *> &examples)
 {
-    const ExampleNodeMap &exampleNodeMap = m_qdb->exampleNodeMap();
-    if (exampleNodeMap.isEmpty())
-        return;
-
-    bool demos = (manifest == QLatin1String("demos"));
-    if (!std::any_of(exampleNodeMap.cbegin(), exampleNodeMap.cend(),
-        [demos](const ExampleNode *en) {
-            return demos == en->name().startsWith("demos");
-        }))
+    if (examples.isEmpty())
         return;
 
     const QString outputFileName = manifest + "-manifest.xml";
@@ -196,10 +201,8 @@ void ManifestWriter::generateManifestFile(const QString &manifest, const QString
     writer.writeAttribute("module", m_project);
     writer.writeStartElement(manifest);
 
-    for (const auto &example : exampleNodeMap.values()) {
+    for (const ExampleNode *example : examples) {
         QMap<QString, QString> usedAttributes;
-        if (demos != example->name().startsWith("demos"))
-            continue;
         m_tags.clear();
         const QString installPath = retrieveExampleInstallationPath(example);
         const QString fullName = m_project + QLatin1Char('/') + example->title();
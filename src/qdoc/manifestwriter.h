@@ -24,7 +24,8 @@ class ManifestWriter
 public:
     ManifestWriter();
     void generateManifestFiles();
-    void generateManifestFile(const QString &manifest, const QString &element);
+    void generateManifestFile(const QString &manifest, const QString &element,
+                              const QList<const ExampleNode *> &examples);
     void readManifestMetaContent();
     QString retrieveExampleInstallationPath(const ExampleNode *example) const;
 
@@ -1205,6 +1205,10 @@ void QDocDatabase::resolveProxies()
 const FunctionNode *QDocDatabase::findFunctionNode(const QString &target, const Node *relative,
                                                    Node::Genus genus)
 {
+    const LinkCacheKey key { target, relative, nullptr, genus, FunctionLink };
+    if (const LinkCacheEntry *entry = cachedLink(key))
+        return static_cast<const FunctionNode *>(entry->node);
+
     QString signature;
     QString function = target;
     qsizetype length = target.length();
@@ -1216,7 +1220,9 @@ const FunctionNode *QDocDatabase::findFunctionNode(const QString &target, const
         function = function.left(position);
     }
     QStringList path = function.split("::");
-    return m_forest.findFunctionNode(path, Parameters(signature), relative, genus);
+    const FunctionNode *fn = m_forest.findFunctionNode(path, Parameters(signature), relative, genus);
+    cacheLink(key, fn);
+    return fn;
 }
 
 /*!
@@ -1230,6 +1236,18 @@ const FunctionNode *QDocDatabase::findFunctionNode(const QString &target, const
   root.
  */
 const Node *QDocDatabase::findTypeNode(const QString &type, const Node *relative, Node::Genus genus)
+{
+    const LinkCacheKey key { type, relative, nullptr, genus, TypeLink };
+    if (const LinkCacheEntry *entry = cachedLink(key))
+        return entry->node;
+
+    const Node *node = resolveTypeNode(type, relative, genus);
+    cacheLink(key, node);
+    return node;
+}
+
+const Node *QDocDatabase::resolveTypeNode(const QString &type, const Node *relative,
+                                          Node::Genus genus)
 {
     QStringList path = type.split("::");
     if ((path.size() == 1) && (path.at(0)[0].isLower() || path.at(0) == QString("T"))) {
@@ -1282,11 +1300,58 @@ QStringList QDocDatabase::groupNamesForNode(Node *node)
     return result;
 }
 
+/*!
+  Enables or disables caching of the nodes found by findNodeForAtom(),
+  findFunctionNode() and findTypeNode(), depending on \a enable.
+
+  The generators resolve the same links, types and functions over and
+  over, for each page and for each output format. While enabled, each
+  combination of target, relative node, and genus is only resolved once.
+  The cache must only be enabled while the trees are not modified; it is
+  cleared whenever the primary tree or the search order changes.
+
+  The cache hits and misses are counted, see linkCacheHits() and
+  linkCacheMisses().
+ */
+void QDocDatabase::setLinkCacheEnabled(bool enable)
+{
+    m_linkCacheEnabled = enable;
+    clearLinkCache();
+}
+
+/*!
+  Returns the cached result for \a key, or \nullptr if the cache is
+  disabled or does not contain \a key.
+ */
+const QDocDatabase::LinkCacheEntry *QDocDatabase::cachedLink(const LinkCacheKey &key)
+{
+    if (!m_linkCacheEnabled)
+        return nullptr;
+    auto it = m_linkCache.constFind(key);
+    if (it == m_linkCache.constEnd()) {
+        ++m_linkCacheMisses;
+        return nullptr;
+    }
+    ++m_linkCacheHits;
+    return &it.value();
+}
+
+/*!
+  Stores \a node and \a ref as the result for \a key, if the cache
+  is enabled. Failed lookups are cached as well.
+ */
+void QDocDatabase::cacheLink(const LinkCacheKey &key, const Node *node, const QString &ref)
+{
+    if (m_linkCacheEnabled)
+        m_linkCache.insert(key, { node, ref });
+}
+
 /*!
   Reads and parses the qdoc index files listed in \a indexFiles.
  */
 void QDocDatabase::readIndexes(const QStringList &indexFiles)
 {
+    clearLinkCache();
     QStringList filesToRead;
     for (const QString &file : indexFiles) {
         QString fn = file.mid(file.lastIndexOf(QChar('/')) + 1);
@@ -1439,6 +1504,29 @@ void QDocDatabase::mergeCollections(CollectionNode *c)
  */
 const Node *QDocDatabase::findNodeForAtom(const Atom *a, const Node *relative, QString &ref,
                                           Node::Genus genus)
+{
+    // A non-empty ref is an input the result could depend on
+    if (!m_linkCacheEnabled || !ref.isEmpty())
+        return resolveNodeForAtom(a, relative, ref, genus);
+
+    Atom *atom = const_cast<Atom *>(a);
+    LinkCacheKey key { atom->string(), relative, nullptr, genus, AtomLink };
+    if (atom->isLinkAtom()) {
+        key.domain = atom->domain();
+        key.genus = atom->genus();
+    }
+    if (const LinkCacheEntry *entry = cachedLink(key)) {
+        ref = entry->ref;
+        return entry->node;
+    }
+
+    const Node *node = resolveNodeForAtom(a, relative, ref, genus);
+    cacheLink(key, node, ref);
+    return node;
+}
+
+const Node *QDocDatabase::resolveNodeForAtom(const Atom *a, const Node *relative, QString &ref,
+                                             Node::Genus genus)
 {
     const Node *node = nullptr;
 
@@ -11,6 +11,7 @@
 #include "tree.h"
 
 #include <QtCore/qdebug.h>
+#include <QtCore/qhash.h>
 #include <QtCore/qmap.h>
 #include <QtCore/qstring.h>
 
@@ -346,25 +347,88 @@ public:
     // Try to make this function private.
     QDocForest &forest() { return m_forest; }
     NamespaceNode *primaryTreeRoot() { return m_forest.primaryTreeRoot(); }
-    void newPrimaryTree(const QString &module) { m_forest.newPrimaryTree(module); }
-    void setPrimaryTree(const QString &t) { m_forest.setPrimaryTree(t); }
+    void newPrimaryTree(const QString &module)
+    {
+        clearLinkCache();
+        m_forest.newPrimaryTree(module);
+    }
+    void setPrimaryTree(const QString &t)
+    {
+        clearLinkCache();
+        m_forest.setPrimaryTree(t);
+    }
     NamespaceNode *newIndexTree(const QString &module) { return m_forest.newIndexTree(module); }
     const QList<Tree *> &searchOrder() { return m_forest.searchOrder(); }
-    void setLocalSearch() { m_forest.m_searchOrder = QList<Tree *>(1, primaryTree()); }
-    void setSearchOrder(const QList<Tree *> &searchOrder) { m_forest.m_searchOrder = searchOrder; }
-    void setSearchOrder(QStringList &t) { m_forest.setSearchOrder(t); }
+    void setLocalSearch()
+    {
+        clearLinkCache();
+        m_forest.m_searchOrder = QList<Tree *>(1, primaryTree());
+    }
+    void setSearchOrder(const QList<Tree *> &searchOrder)
+    {
+        clearLinkCache();
+        m_forest.m_searchOrder = searchOrder;
+    }
+    void setSearchOrder(QStringList &t)
+    {
+        clearLinkCache();
+        m_forest.setSearchOrder(t);
+    }
     void mergeCollections(Node::NodeType type, CNMap &cnm, const Node *relative);
     void mergeCollections(CollectionNode *c);
-    void clearSearchOrder() { m_forest.clearSearchOrder(); }
+    void clearSearchOrder()
+    {
+        clearLinkCache();
+        m_forest.clearSearchOrder();
+    }
     QStringList keys() { return m_forest.keys(); }
     void resolveNamespaces();
     void resolveProxies();
     void resolveBaseClasses();
     void updateNavigation();
 
+    void setLinkCacheEnabled(bool enable);
+    void clearLinkCache() { m_linkCache.clear(); }
+    [[nodiscard]] qint64 linkCacheHits() const { return m_linkCacheHits; }
+    [[nodiscard]] qint64 linkCacheMisses() const { return m_linkCacheMisses; }
+
 private:
     friend class Tree;
 
+    enum LinkCacheKind { AtomLink, FunctionLink, TypeLink };
+
+    struct LinkCacheKey
+    {
+        QString target;
+        const Node *relative = nullptr;
+        const Tree *domain = nullptr;
+        int genus = Node::DontCare;
+        LinkCacheKind kind = AtomLink;
+
+        friend bool operator==(const LinkCacheKey &a, const LinkCacheKey &b) noexcept
+        {
+            return a.kind == b.kind && a.genus == b.genus && a.relative == b.relative
+                    && a.domain == b.domain && a.target == b.target;
+        }
+        friend size_t qHash(const LinkCacheKey &key, size_t seed = 0) noexcept
+        {
+            return qHashMulti(seed, key.target, key.relative, key.domain, key.genus,
+                              int(key.kind));
+        }
+    };
+
+    struct LinkCacheEntry
+    {
+        const Node *node = nullptr;
+        QString ref;
+    };
+
+    const LinkCacheEntry *cachedLink(const LinkCacheKey &key);
+    void cacheLink(const LinkCacheKey &key, const Node *node, const QString &ref = QString());
+    const Node *resolveNodeForAtom(const Atom *atom, const Node *relative, QString &ref,
+                                   Node::Genus genus);
+    const Node *resolveTypeNode(const QString &type, const Node *relative, Node::Genus genus);
+
     const Node *findNode(const QStringList &path, const Node *relative, int findFlags,
                          Node::Genus genus)
     {
@@ -405,6 +469,12 @@ private:
     NodeMapMap m_functionIndex {};
     TextToNodeMap m_legaleseTexts {};
     QSet<QString> m_openNamespaces {};
+
+    // Resolved link targets, only used while the trees are not modified
+    bool m_linkCacheEnabled { false };
+    QHash<LinkCacheKey, LinkCacheEntry> m_linkCache {};
+    qint64 m_linkCacheHits { 0 };
+    qint64 m_linkCacheMisses { 0 };
 };
 
 QT_END_NAMESPACE
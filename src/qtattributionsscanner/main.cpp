@@ -48,6 +48,10 @@ int main(int argc, char *argv[])
     QCommandLineOption outputOption({ QStringLiteral("o"), QStringLiteral("output") },
                                     tr("Write generated data to <file>."),
                                     QStringLiteral("file"));
+    QCommandLineOption cacheOption(QStringLiteral("cache"),
+                                   tr("Keep the parsed attribution files in <file>, so that "
+                                      "repeated scans only read the files that changed."),
+                                   QStringLiteral("file"));
     QCommandLineOption verboseOption(QStringLiteral("verbose"),
                                      tr("Verbose output."));
     QCommandLineOption silentOption({ QStringLiteral("s"), QStringLiteral("silent") },
@@ -58,6 +62,7 @@ int main(int argc, char *argv[])
     parser.addOption(filterOption);
     parser.addOption(baseDirOption);
     parser.addOption(outputOption);
+    parser.addOption(cacheOption);
     parser.addOption(verboseOption);
     parser.addOption(silentOption);
 
@@ -99,7 +104,7 @@ int main(int argc, char *argv[])
         if (logLevel == VerboseLog)
             std::cerr << qPrintable(tr("Recursively scanning %1 for attribution files...").arg(
                                         QDir::toNativeSeparators(path))) << std::endl;
-        packages = Scanner::scanDirectory(path, formats, logLevel);
+        packages = Scanner::scanDirectory(path, formats, logLevel, parser.value(cacheOption));
     } else if (pathInfo.isFile()) {
         packages = Scanner::readFile(path, logLevel);
     } else {
@@ -4,23 +4,57 @@
 #include "scanner.h"
 #include "logging.h"
 
+#include <QtCore/qbytearraylist.h>
+#include <QtCore/qdatastream.h>
+#include <QtCore/qdatetime.h>
 #include <QtCore/qdir.h>
 #include <QtCore/qhash.h>
 #include <QtCore/qjsonarray.h>
 #include <QtCore/qjsondocument.h>
 #include <QtCore/qjsonobject.h>
+#include <QtCore/qsavefile.h>
 #include <QtCore/qtextstream.h>
+#include <QtCore/qthreadpool.h>
 #include <QtCore/qvariant.h>
 
 #include <iostream>
+#include <memory>
 #include <optional>
+#include <sstream>
+#include <vector>
+
+// Package has no stream operators of its own; these are for the cache file.
+static QDataStream &operator<<(QDataStream &out, const Package &p)
+{
+    return out << p.id << p.path << p.files << p.name << p.qdocModule << p.qtUsage << p.qtParts
+               << p.description << p.homepage << p.version << p.downloadLocation << p.license
+               << p.licenseId << p.licenseFiles << p.copyright << p.copyrightFile
+               << p.packageComment;
+}
+
+static QDataStream &operator>>(QDataStream &in, Package &p)
+{
+    return in >> p.id >> p.path >> p.files >> p.name >> p.qdocModule >> p.qtUsage >> p.qtParts
+              >> p.description >> p.homepage >> p.version >> p.downloadLocation >> p.license
+              >> p.licenseId >> p.licenseFiles >> p.copyright >> p.copyrightFile
+              >> p.packageComment;
+}
 
 namespace Scanner {
 
+// Files are parsed on worker threads. Their diagnostics are collected per
+// file and printed in scan order, so that the output does not depend on timing.
+static thread_local std::ostream *diagnostics = nullptr;
+
+static std::ostream &errorStream()
+{
+    return diagnostics ? *diagnostics : std::cerr;
+}
+
 static void missingPropertyWarning(const QString &filePath, const QString &property)
 {
-    std::cerr << qPrintable(tr("File %1: Missing mandatory property '%2'.").arg(
-                                QDir::toNativeSeparators(filePath), property)) << std::endl;
+    errorStream() << qPrintable(tr("File %1: Missing mandatory property '%2'.").arg(
+                                    QDir::toNativeSeparators(filePath), property)) << std::endl;
 }
 
 static void validatePackage(Package &p, const QString &filePath, LogLevel logLevel)
@@ -42,10 +76,10 @@ static void validatePackage(Package &p, const QString &filePath, LogLevel logLev
             missingPropertyWarning(filePath, QStringLiteral("License"));
 
         if (!p.copyright.isEmpty() && !p.copyrightFile.isEmpty()) {
-            std::cerr << qPrintable(tr("File %1: Properties 'Copyright' and 'CopyrightFile' are "
-                                       "mutually exclusive.")
-                                            .arg(QDir::toNativeSeparators(filePath)))
-                      << std::endl;
+            errorStream() << qPrintable(tr("File %1: Properties 'Copyright' and 'CopyrightFile' are "
+                                           "mutually exclusive.")
+                                                .arg(QDir::toNativeSeparators(filePath)))
+                          << std::endl;
         }
 
         for (const QString &part : qAsConst(p.qtParts)) {
@@ -54,11 +88,11 @@ static void validatePackage(Package &p, const QString &filePath, LogLevel logLev
                     && part != QLatin1String("tools")
                     && part != QLatin1String("libs")
                     && logLevel != SilentLog) {
-                std::cerr << qPrintable(tr("File %1: Property 'QtPart' contains unknown element "
-                                           "'%2'. Valid entries are 'examples', 'tests', 'tools' "
-                                           "and 'libs'.").arg(
-                                            QDir::toNativeSeparators(filePath), part))
-                          << std::endl;
+                errorStream() << qPrintable(tr("File %1: Property 'QtPart' contains unknown element "
+                                               "'%2'. Valid entries are 'examples', 'tests', 'tools' "
+                                               "and 'libs'.").arg(
+                                                QDir::toNativeSeparators(filePath), part))
+                              << std::endl;
             }
         }
     }
@@ -90,8 +124,8 @@ static Package readPackage(const QJsonObject &object, const QString &filePath, L
         if (!iter.value().isString() && key != QLatin1String("QtParts")
             && key != QLatin1String("LicenseFiles")) {
             if (logLevel != SilentLog)
-                std::cerr << qPrintable(tr("File %1: Expected JSON string as value of %2.").arg(
-                                            QDir::toNativeSeparators(filePath), key)) << std::endl;
+                errorStream() << qPrintable(tr("File %1: Expected JSON string as value of %2.").arg(
+                                                QDir::toNativeSeparators(filePath), key)) << std::endl;
             continue;
         }
         const QString value = iter.value().toString();
@@ -118,9 +152,9 @@ static Package readPackage(const QJsonObject &object, const QString &filePath, L
         } else if (key == QLatin1String("LicenseFiles")) {
             auto strings = toStringList(iter.value());
             if (!strings && (logLevel != SilentLog))
-                std::cerr << qPrintable(tr("File %1: Expected JSON array of strings in %2.")
-                                                .arg(QDir::toNativeSeparators(filePath), key))
-                          << std::endl;
+                errorStream() << qPrintable(tr("File %1: Expected JSON array of strings in %2.")
+                                                    .arg(QDir::toNativeSeparators(filePath), key))
+                              << std::endl;
             const QDir dir(directory);
             for (auto iter : strings.value())
                 p.licenseFiles.push_back(dir.absoluteFilePath(iter));
@@ -139,14 +173,14 @@ static Package readPackage(const QJsonObject &object, const QString &filePath, L
         } else if (key == QLatin1String("QtParts")) {
             auto parts = toStringList(iter.value());
             if (!parts && (logLevel != SilentLog))
-                std::cerr << qPrintable(tr("File %1: Expected JSON array of strings in %2.")
-                                                .arg(QDir::toNativeSeparators(filePath), key))
-                          << std::endl;
+                errorStream() << qPrintable(tr("File %1: Expected JSON array of strings in %2.")
+                                                    .arg(QDir::toNativeSeparators(filePath), key))
+                              << std::endl;
             p.qtParts = parts.value();
         } else {
             if (logLevel != SilentLog)
-                std::cerr << qPrintable(tr("File %1: Unknown key %2.").arg(
-                                            QDir::toNativeSeparators(filePath), key)) << std::endl;
+                errorStream() << qPrintable(tr("File %1: Unknown key %2.").arg(
+                                                QDir::toNativeSeparators(filePath), key)) << std::endl;
         }
     }
 
@@ -235,14 +269,14 @@ QList<Package> readFile(const QString &filePath, LogLevel logLevel)
     QList<Package> packages;
 
     if (logLevel == VerboseLog) {
-        std::cerr << qPrintable(tr("Reading file %1...").arg(
-                                    QDir::toNativeSeparators(filePath))) << std::endl;
+        errorStream() << qPrintable(tr("Reading file %1...").arg(
+                                        QDir::toNativeSeparators(filePath))) << std::endl;
     }
     QFile file(filePath);
     if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
         if (logLevel != SilentLog)
-            std::cerr << qPrintable(tr("Could not open file %1.").arg(
-                                        QDir::toNativeSeparators(file.fileName()))) << std::endl;
+            errorStream() << qPrintable(tr("Could not open file %1.").arg(
+                                            QDir::toNativeSeparators(file.fileName()))) << std::endl;
         return QList<Package>();
     }
 
@@ -251,10 +285,10 @@ QList<Package> readFile(const QString &filePath, LogLevel logLevel)
         const QJsonDocument document = QJsonDocument::fromJson(file.readAll(), &jsonParseError);
         if (document.isNull()) {
             if (logLevel != SilentLog)
-                std::cerr << qPrintable(tr("Could not parse file %1: %2").arg(
-                                            QDir::toNativeSeparators(file.fileName()),
-                                            jsonParseError.errorString()))
-                          << std::endl;
+                errorStream() << qPrintable(tr("Could not parse file %1: %2").arg(
+                                                QDir::toNativeSeparators(file.fileName()),
+                                                jsonParseError.errorString()))
+                              << std::endl;
             return QList<Package>();
         }
 
@@ -268,15 +302,15 @@ QList<Package> readFile(const QString &filePath, LogLevel logLevel)
                     packages << readPackage(value.toObject(), file.fileName(), logLevel);
                 } else {
                     if (logLevel != SilentLog)
-                        std::cerr << qPrintable(tr("File %1: Expecting JSON object in array.")
-                                        .arg(QDir::toNativeSeparators(file.fileName())))
-                                  << std::endl;
+                        errorStream() << qPrintable(tr("File %1: Expecting JSON object in array.")
+                                            .arg(QDir::toNativeSeparators(file.fileName())))
+                                      << std::endl;
                 }
             }
         } else {
             if (logLevel != SilentLog)
-                std::cerr << qPrintable(tr("File %1: Expecting JSON object in array.").arg(
-                                            QDir::toNativeSeparators(file.fileName()))) << std::endl;
+                errorStream() << qPrintable(tr("File %1: Expecting JSON object in array.").arg(
+                                                QDir::toNativeSeparators(file.fileName()))) << std::endl;
         }
     } else if (filePath.endsWith(QLatin1String(".chromium"))) {
         Package chromiumPackage = parseChromiumFile(file, filePath, logLevel);
@@ -284,19 +318,183 @@ QList<Package> readFile(const QString &filePath, LogLevel logLevel)
             packages << chromiumPackage;
     } else {
         if (logLevel != SilentLog)
-            std::cerr << qPrintable(tr("File %1: Unsupported file type.")
-                            .arg(QDir::toNativeSeparators(file.fileName())))
-                      << std::endl;
+            errorStream() << qPrintable(tr("File %1: Unsupported file type.")
+                                .arg(QDir::toNativeSeparators(file.fileName())))
+                          << std::endl;
     }
 
     return packages;
 }
 
-QList<Package> scanDirectory(const QString &directory, InputFormats inputFormats, LogLevel logLevel)
+struct ScannedFile
+{
+    QString path;
+    QString absolutePath; // the key in the cache
+    qint64 size = 0;
+    qint64 lastModified = 0; // msecs since epoch
+    QByteArray fallbackState; // see licenseFallbackState()
+    QList<Package> packages;
+    std::string diagnostics;
+};
+
+struct ScannedDirectory
+{
+    QString path;
+    // files and subdirectories, in the order QDir lists them
+    std::vector<std::unique_ptr<ScannedFile>> files;
+    std::vector<std::unique_ptr<ScannedDirectory>> directories;
+    QList<QPair<bool, int>> entries; // (isDirectory, index)
+};
+
+// parseChromiumFile() falls back to the LICENSE or COPYING file next to
+// a README.chromium file. Returns the names, sizes and modification times
+// of those files, so that a cached result is not used once they change.
+static QByteArray licenseFallbackState(const QFileInfo &info)
+{
+    QByteArray state;
+    if (!info.fileName().endsWith(QLatin1String(".chromium")))
+        return state;
+
+    QDir dir = info.absoluteDir();
+    dir.setNameFilters({ QStringLiteral("LICENSE"), QStringLiteral("COPYING") });
+    dir.setFilter(QDir::Files | QDir::NoDotAndDotDot);
+
+    QDataStream out(&state, QIODevice::WriteOnly);
+    const QFileInfoList entries = dir.entryInfoList();
+    for (const QFileInfo &entry : entries)
+        out << entry.fileName() << entry.size() << entry.lastModified().toMSecsSinceEpoch();
+    return state;
+}
+
+static void listDirectory(QThreadPool *pool, ScannedDirectory *directory,
+                          const QStringList &nameFilters)
+{
+    QDir dir(directory->path);
+    dir.setNameFilters(nameFilters);
+    dir.setFilter(QDir::AllDirs | QDir::NoDotAndDotDot | QDir::Files);
+
+    const QFileInfoList entries = dir.entryInfoList();
+    for (const QFileInfo &info : entries) {
+        if (info.isDir()) {
+            directory->entries.append({ true, int(directory->directories.size()) });
+            auto child = std::make_unique<ScannedDirectory>();
+            child->path = info.filePath();
+            ScannedDirectory *c = child.get();
+            directory->directories.push_back(std::move(child));
+            pool->start([pool, c, nameFilters] { listDirectory(pool, c, nameFilters); });
+        } else {
+            directory->entries.append({ false, int(directory->files.size()) });
+            auto file = std::make_unique<ScannedFile>();
+            file->path = info.filePath();
+            file->absolutePath = info.absoluteFilePath();
+            file->size = info.size();
+            file->lastModified = info.lastModified().toMSecsSinceEpoch();
+            file->fallbackState = licenseFallbackState(info);
+            directory->files.push_back(std::move(file));
+        }
+    }
+}
+
+static void collectFiles(ScannedDirectory *directory, QList<ScannedFile *> *files)
+{
+    for (const auto &entry : qAsConst(directory->entries)) {
+        if (entry.first)
+            collectFiles(directory->directories.at(entry.second).get(), files);
+        else
+            files->append(directory->files.at(entry.second).get());
+    }
+}
+
+static const quint32 CacheMagic = 0x51415343; // "QASC"
+static const quint32 CacheVersion = 3;
+
+struct CachedFile
 {
-    QDir dir(directory);
+    qint64 size;
+    qint64 lastModified;
+    QByteArray fallbackState;
+    QByteArrayList diagnostics; // see splitDiagnostics()
     QList<Package> packages;
+};
+
+typedef QHash<QString, CachedFile> Cache;
+
+// The diagnostics name the file by the path it was scanned with, which
+// depends on the scan root, while the cache is keyed on the absolute path.
+// So they are cached split at that path and joined with the path of the
+// current scan when they are printed.
+static QByteArray diagnosticsPath(const ScannedFile *f)
+{
+    return QDir::toNativeSeparators(f->path).toLocal8Bit();
+}
+
+static QByteArrayList splitDiagnostics(const ScannedFile *f)
+{
+    const QByteArray text = QByteArray::fromStdString(f->diagnostics);
+    const QByteArray path = diagnosticsPath(f);
+    QByteArrayList parts;
+    qsizetype from = 0;
+    for (qsizetype pos; (pos = text.indexOf(path, from)) != -1; from = pos + path.size())
+        parts.append(text.mid(from, pos - from));
+    parts.append(text.mid(from));
+    return parts;
+}
+
+// The cache is only valid for the log level it was written with, as the
+// diagnostics are part of it.
+static Cache readCache(const QString &cacheFilePath, LogLevel logLevel)
+{
+    Cache cache;
+    QFile file(cacheFilePath);
+    if (!file.open(QIODevice::ReadOnly))
+        return cache;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_0);
+    quint32 magic, version;
+    qint32 level;
+    in >> magic >> version >> level;
+    if (magic != CacheMagic || version != CacheVersion || level != logLevel)
+        return cache;
+
+    qint32 count;
+    in >> count;
+    for (qint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        QString path;
+        CachedFile entry;
+        in >> path >> entry.size >> entry.lastModified >> entry.fallbackState
+           >> entry.diagnostics >> entry.packages;
+        cache.insert(path, entry);
+    }
+    if (in.status() != QDataStream::Ok)
+        cache.clear();
+    return cache;
+}
+
+static void writeCache(const QString &cacheFilePath, LogLevel logLevel,
+                       const QList<ScannedFile *> &files)
+{
+    QSaveFile file(cacheFilePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        if (logLevel != SilentLog)
+            errorStream() << qPrintable(tr("Cannot write cache file %1.").arg(
+                                        QDir::toNativeSeparators(cacheFilePath))) << std::endl;
+        return;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << CacheMagic << CacheVersion << qint32(logLevel) << qint32(files.size());
+    for (const ScannedFile *f : files) {
+        out << f->absolutePath << f->size << f->lastModified << f->fallbackState
+            << splitDiagnostics(f) << f->packages;
+    }
+    file.commit();
+}
 
+QList<Package> scanDirectory(const QString &directory, InputFormats inputFormats, LogLevel logLevel,
+                             const QString &cacheFilePath)
+{
     QStringList nameFilters = QStringList();
     if (inputFormats & InputFormat::QtAttributions)
         nameFilters << QStringLiteral("qt_attribution.json");
@@ -308,17 +506,46 @@ QList<Package> scanDirectory(const QString &directory, InputFormats inputFormats
                 << QStringLiteral("README_test.chromium");
     }
 
-    dir.setNameFilters(nameFilters);
-    dir.setFilter(QDir::AllDirs | QDir::NoDotAndDotDot | QDir::Files);
-
-    const QFileInfoList entries = dir.entryInfoList();
-    for (const QFileInfo &info : entries) {
-        if (info.isDir()) {
-            packages += scanDirectory(info.filePath(), inputFormats, logLevel);
-        } else {
-            packages += readFile(info.filePath(), logLevel);
+    // Walk the tree, listing the directories in parallel. Only matching
+    // files are returned by QDir, so nothing else gets looked at.
+    QThreadPool pool;
+    ScannedDirectory root;
+    root.path = directory;
+    listDirectory(&pool, &root, nameFilters);
+    pool.waitForDone();
+
+    QList<ScannedFile *> files;
+    collectFiles(&root, &files);
+
+    const Cache cache = cacheFilePath.isEmpty() ? Cache() : readCache(cacheFilePath, logLevel);
+    for (ScannedFile *f : qAsConst(files)) {
+        const auto cached = cache.constFind(f->absolutePath);
+        if (cached != cache.cend() && cached->size == f->size
+            && cached->lastModified == f->lastModified
+            && cached->fallbackState == f->fallbackState) {
+            f->packages = cached->packages;
+            f->diagnostics = cached->diagnostics.join(diagnosticsPath(f)).toStdString();
+            continue;
         }
+        pool.start([f, logLevel] {
+            std::ostringstream stream;
+            diagnostics = &stream;
+            f->packages = readFile(f->path, logLevel);
+            diagnostics = nullptr;
+            f->diagnostics = stream.str();
+        });
     }
+    pool.waitForDone();
+
+    QList<Package> packages;
+    for (const ScannedFile *f : qAsConst(files)) {
+        std::cerr << f->diagnostics;
+        packages += f->packages;
+    }
+    std::cerr.flush();
+
+    if (!cacheFilePath.isEmpty())
+        writeCache(cacheFilePath, logLevel, files);
 
     return packages;
 }
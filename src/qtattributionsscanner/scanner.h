@@ -20,7 +20,8 @@ Q_DECLARE_FLAGS(InputFormats, InputFormat)
 Q_DECLARE_OPERATORS_FOR_FLAGS(InputFormats)
 
 QList<Package> readFile(const QString &filePath, LogLevel logLevel);
-QList<Package> scanDirectory(const QString &directory, InputFormats inputFormats, LogLevel logLevel);
+QList<Package> scanDirectory(const QString &directory, InputFormats inputFormats, LogLevel logLevel,
+                             const QString &cacheFilePath = QString());
 
 }
 
@@ -8,6 +8,7 @@
 #include <QtCore/QMimeData>
 #include <QtGui/QImage>
 #include <QtGui/QPainter>
+#include <QtGui/QPixmap>
 #include <QtWidgets/QScrollBar>
 #include <QtGui/QMouseEvent>
 #include <QtWidgets/QRubberBand>
@@ -51,6 +52,7 @@ public:
     QtGradientStop *newStop(const QPoint &viewportPos);
 
     bool m_backgroundCheckered;
+    QPixmap m_checkerTile; // created on first use
     QtGradientStopsModel *m_model;
     double m_handleSize;
     int m_scaleFactor;
@@ -727,24 +729,22 @@ void QtGradientStopsWidget::paintEvent(QPaintEvent *e)
     if (w <= 0)
         return;
 
-    QPixmap pix(size);
-    QPainter p;
+    QPainter p(viewport());
 
     if (d_ptr->m_backgroundCheckered) {
-        int pixSize = 20;
-        QPixmap pm(2 * pixSize, 2 * pixSize);
-        QPainter pmp(&pm);
-        pmp.fillRect(0, 0, pixSize, pixSize, Qt::white);
-        pmp.fillRect(pixSize, pixSize, pixSize, pixSize, Qt::white);
-        pmp.fillRect(0, pixSize, pixSize, pixSize, Qt::black);
-        pmp.fillRect(pixSize, 0, pixSize, pixSize, Qt::black);
-
-        p.begin(&pix);
+        const int pixSize = 20;
+        if (d_ptr->m_checkerTile.isNull()) {
+            d_ptr->m_checkerTile = QPixmap(2 * pixSize, 2 * pixSize);
+            QPainter pmp(&d_ptr->m_checkerTile);
+            pmp.fillRect(0, 0, pixSize, pixSize, Qt::white);
+            pmp.fillRect(pixSize, pixSize, pixSize, pixSize, Qt::white);
+            pmp.fillRect(0, pixSize, pixSize, pixSize, Qt::black);
+            pmp.fillRect(pixSize, 0, pixSize, pixSize, Qt::black);
+        }
+
         p.setBrushOrigin((size.width() % pixSize + pixSize) / 2, (size.height() % pixSize + pixSize) / 2);
-        p.fillRect(viewport()->rect(), pm);
+        p.fillRect(viewport()->rect(), d_ptr->m_checkerTile);
         p.setBrushOrigin(0, 0);
-    } else {
-        p.begin(viewport());
     }
 
     const double viewBegin = double(w) * horizontalScrollBar()->value() / d_ptr->m_scaleFactor;
@@ -869,12 +869,6 @@ void QtGradientStopsWidget::paintEvent(QPaintEvent *e)
             p.restore();
         }
     }
-    if (d_ptr->m_backgroundCheckered) {
-        p.end();
-        p.begin(viewport());
-        p.drawPixmap(0, 0, pix);
-    }
-    p.end();
 }
 
 void QtGradientStopsWidget::focusInEvent(QFocusEvent *e)
@@ -5,6 +5,7 @@
 #include <QtCore/QMap>
 #include <QtGui/QImage>
 #include <QtGui/QPainter>
+#include <QtGui/QPixmap>
 #include <QtWidgets/QScrollBar>
 #include <QtGui/QMouseEvent>
 #include <QtGui/QRegion>
@@ -33,6 +34,8 @@ public:
     void setAngleConical(double angle);
 
     void paintPoint(QPainter *painter, const QPointF &point, double size) const;
+    QGradient currentGradient() const;
+    const QPixmap &checkerTile();
 
     double m_handleSize;
     bool m_backgroundCheckered;
@@ -66,8 +69,48 @@ public:
     double m_dragRadius;
     double m_angleOffset;
     double m_dragAngle;
+
+    // The tile of the checkered background, created once, as the gradient
+    // itself changes with every move of a handle
+    QPixmap m_checkerTile;
 };
 
+QGradient QtGradientWidgetPrivate::currentGradient() const
+{
+    QGradient gradient;
+    switch (m_gradientType) {
+        case QGradient::LinearGradient:
+            gradient = QLinearGradient(m_startLinear, m_endLinear);
+            break;
+        case QGradient::RadialGradient:
+            gradient = QRadialGradient(m_centralRadial, m_radiusRadial, m_focalRadial);
+            break;
+        case QGradient::ConicalGradient:
+            gradient = QConicalGradient(m_centralConical, m_angleConical);
+            break;
+        default:
+            return gradient;
+    }
+    gradient.setStops(m_gradientStops);
+    gradient.setSpread(m_gradientSpread);
+    return gradient;
+}
+
+const QPixmap &QtGradientWidgetPrivate::checkerTile()
+{
+    if (m_checkerTile.isNull()) {
+        int pixSize = 40;
+        m_checkerTile = QPixmap(2 * pixSize, 2 * pixSize);
+
+        QPainter pmp(&m_checkerTile);
+        pmp.fillRect(0, 0, pixSize, pixSize, Qt::white);
+        pmp.fillRect(pixSize, pixSize, pixSize, pixSize, Qt::white);
+        pmp.fillRect(0, pixSize, pixSize, pixSize, Qt::black);
+        pmp.fillRect(pixSize, 0, pixSize, pixSize, Qt::black);
+    }
+    return m_checkerTile;
+}
+
 double QtGradientWidgetPrivate::correctAngle(double angle) const
 {
     double a = angle;
@@ -446,43 +489,20 @@ void QtGradientWidget::paintEvent(QPaintEvent *e)
     QPainter p(this);
 
     if (d_ptr->m_backgroundCheckered) {
-        int pixSize = 40;
-        QPixmap pm(2 * pixSize, 2 * pixSize);
-
-        QPainter pmp(&pm);
-        pmp.fillRect(0, 0, pixSize, pixSize, Qt::white);
-        pmp.fillRect(pixSize, pixSize, pixSize, pixSize, Qt::white);
-        pmp.fillRect(0, pixSize, pixSize, pixSize, Qt::black);
-        pmp.fillRect(pixSize, 0, pixSize, pixSize, Qt::black);
-
+        const QPixmap &pm = d_ptr->checkerTile();
+        const int pixSize = pm.width() / 2;
         p.setBrushOrigin((size().width() % pixSize + pixSize) / 2, (size().height() % pixSize + pixSize) / 2);
         p.fillRect(rect(), pm);
         p.setBrushOrigin(0, 0);
     }
 
-    QGradient *gradient = nullptr;
-    switch (d_ptr->m_gradientType) {
-        case QGradient::LinearGradient:
-            gradient = new QLinearGradient(d_ptr->m_startLinear, d_ptr->m_endLinear);
-            break;
-        case QGradient::RadialGradient:
-            gradient = new QRadialGradient(d_ptr->m_centralRadial, d_ptr->m_radiusRadial, d_ptr->m_focalRadial);
-            break;
-        case QGradient::ConicalGradient:
-            gradient = new QConicalGradient(d_ptr->m_centralConical, d_ptr->m_angleConical);
-            break;
-        default:
-            break;
-    }
-    if (!gradient)
+    const QGradient gradient = d_ptr->currentGradient();
+    if (gradient.type() == QGradient::NoGradient)
         return;
 
-    gradient->setStops(d_ptr->m_gradientStops);
-    gradient->setSpread(d_ptr->m_gradientSpread);
-
     p.save();
     p.scale(size().width(), size().height());
-    p.fillRect(QRect(0, 0, 1, 1), *gradient);
+    p.fillRect(QRect(0, 0, 1, 1), gradient);
     p.restore();
 
     p.setRenderHint(QPainter::Antialiasing);
@@ -610,8 +630,6 @@ void QtGradientWidget::paintEvent(QPaintEvent *e)
         p.restore();
 
     }
-
-    delete gradient;
 }
 
 void QtGradientWidget::setGradientStops(const QGradientStops &stops)
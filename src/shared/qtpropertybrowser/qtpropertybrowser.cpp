@@ -1196,6 +1196,7 @@ public:
     void slotPropertyRemoved(QtProperty *property, QtProperty *parentProperty);
     void slotPropertyDestroyed(QtProperty *property);
     void slotPropertyDataChanged(QtProperty *property);
+    void updateProperty(QtProperty *property);
 
     QList<QtProperty *> m_subItems;
     QMap<QtAbstractPropertyManager *, QList<QtProperty *> > m_managerToProperties;
@@ -1206,10 +1207,15 @@ public:
     QMap<QtProperty *, QList<QtBrowserItem *> > m_propertyToIndexes;
 
     QtBrowserItem *m_currentItem;
+
+    int m_updateLevel;
+    QList<QtProperty *> m_changedProperties; // while updating, in order of change
+    QSet<QtProperty *> m_changedPropertySet;
 };
 
 QtAbstractPropertyBrowserPrivate::QtAbstractPropertyBrowserPrivate() :
-   m_currentItem(0)
+   m_currentItem(0),
+   m_updateLevel(0)
 {
 }
 
@@ -1417,6 +1423,18 @@ void QtAbstractPropertyBrowserPrivate::slotPropertyDataChanged(QtProperty *prope
     if (!m_propertyToParents.contains(property))
         return;
 
+    if (m_updateLevel > 0) {
+        if (!m_changedPropertySet.contains(property)) {
+            m_changedPropertySet.insert(property);
+            m_changedProperties.append(property);
+        }
+        return;
+    }
+    updateProperty(property);
+}
+
+void QtAbstractPropertyBrowserPrivate::updateProperty(QtProperty *property)
+{
     const auto it = m_propertyToIndexes.constFind(property);
     if (it == m_propertyToIndexes.constEnd())
         return;
@@ -1910,6 +1928,43 @@ void QtAbstractPropertyBrowser::setCurrentItem(QtBrowserItem *item)
         emit  currentItemChanged(item);
 }
 
+/*!
+    Starts a batch of property changes. Until the matching endUpdate(),
+    changes of the properties are collected instead of updating the
+    items one by one. Calls can be nested.
+
+    \sa endUpdate()
+*/
+void QtAbstractPropertyBrowser::beginUpdate()
+{
+    if (d_ptr->m_updateLevel++ == 0)
+        setUpdatesEnabled(false);
+}
+
+/*!
+    Ends a batch of property changes started by beginUpdate(). When the
+    outermost batch ends, the items of each changed property are updated
+    once and the browser is repainted once.
+
+    \sa beginUpdate()
+*/
+void QtAbstractPropertyBrowser::endUpdate()
+{
+    Q_ASSERT(d_ptr->m_updateLevel > 0);
+    if (d_ptr->m_updateLevel == 0 || --d_ptr->m_updateLevel > 0)
+        return;
+
+    const QList<QtProperty *> changedProperties = d_ptr->m_changedProperties;
+    d_ptr->m_changedProperties.clear();
+    d_ptr->m_changedPropertySet.clear();
+    // Properties removed meanwhile are no longer in the index and are skipped
+    for (QtProperty *property : changedProperties) {
+        if (d_ptr->m_propertyToParents.contains(property))
+            d_ptr->updateProperty(property);
+    }
+    setUpdatesEnabled(true);
+}
+
 QT_END_NAMESPACE
 
 #include "moc_qtpropertybrowser.cpp"
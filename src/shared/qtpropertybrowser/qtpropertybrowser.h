@@ -228,6 +228,9 @@ public:
     QtBrowserItem *currentItem() const;
     void setCurrentItem(QtBrowserItem *);
 
+    void beginUpdate();
+    void endUpdate();
+
 Q_SIGNALS:
     void currentItemChanged(QtBrowserItem *);
 
@@ -0,0 +1,26 @@
+<?xml version="1.0" encoding="utf-8"?>
+<!DOCTYPE TS>
+<TS version="2.1">
+<context>
+    <name>Escapes &amp; Entities</name>
+    <message>
+        <source>A plain source text which is longer than one block</source>
+        <translation>Ein einfacher Quelltext, der länger als ein Block ist</translation>
+    </message>
+    <message>
+        <source>&lt;b&gt;Bold&lt;/b&gt; &amp; &quot;quoted&quot; &apos;text&apos;</source>
+        <comment>0123456789abcde&amp;0123456789abcdef&lt;</comment>
+        <translation>&lt;b&gt;Fett&lt;/b&gt; &amp; „zitiert“ &apos;Text&apos;</translation>
+    </message>
+    <message>
+        <source>Control<byte value="x1"/>characters<byte value="xd"/>
+and	tabs</source>
+        <translation>Steuer<byte value="x1"/>zeichen<byte value="xd"/>
+und	Tabs</translation>
+    </message>
+    <message>
+        <source>No&#xa0;break&#x3000;space and 漢字 and 😀 in a long line</source>
+        <translation>Kein&#xa0;Umbruch&#x3000;und 漢字 und 😀 in einer langen Zeile</translation>
+    </message>
+</context>
+</TS>
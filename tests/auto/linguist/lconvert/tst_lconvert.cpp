@@ -180,6 +180,7 @@ void tst_lconvert::readverifies_data()
     QTest::newRow("relative locations") << "relative.ts" << "ts";
     QTest::newRow("message ids") << "msgid.ts" << "ts";
     QTest::newRow("length variants") << "variants.ts" << "ts";
+    QTest::newRow("escapes") << "escapes.ts" << "ts";
     QTest::newRow("qph") << "phrasebook.qph" << "qph";
 }
 
@@ -27,6 +27,7 @@ private slots:
     void registerDocumentation();
     void unregisterDocumentation();
     void documentationFileName();
+    void collectionIndexes();
 
     void customFilters();
     void removeCustomFilter();
@@ -231,6 +232,69 @@ void tst_QHelpEngineCore::documentationFileName()
         QString());
 }
 
+void tst_QHelpEngineCore::collectionIndexes()
+{
+    {
+        QHelpEngineCore c(m_colFile);
+        c.setReadOnly(false);
+        QCOMPARE(c.setupData(), true);
+    }
+
+    // Removed only once db and query below have gone out of scope
+    auto cleanup = qScopeGuard([] { QSqlDatabase::removeDatabase("testdb"); });
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", "testdb");
+        db.setDatabaseName(m_colFile);
+        QVERIFY(db.open());
+        QSqlQuery query(db);
+
+        QVERIFY(query.exec("PRAGMA user_version"));
+        QVERIFY(query.next());
+        QVERIFY(query.value(0).toInt() >= 1);
+
+        const auto queryPlan = [&query](const QString &statement) {
+            QString plan;
+            if (!query.exec(QLatin1String("EXPLAIN QUERY PLAN ") + statement))
+                return plan;
+            while (query.next())
+                plan += query.value(3).toString() + QLatin1Char('\n');
+            return plan;
+        };
+
+        // The joins used by QHelpCollectionHandler::indicesForFilter() and
+        // QHelpCollectionHandler::documentsForField() without filter attributes
+        const QString joins = QLatin1String(
+                    "FROM "
+                        "IndexTable, "
+                        "FileNameTable, "
+                        "FolderTable, "
+                        "NamespaceTable "
+                    "WHERE IndexTable.FileId = FileNameTable.FileId "
+                    "AND FileNameTable.FolderId = FolderTable.Id "
+                    "AND IndexTable.NamespaceId = NamespaceTable.Id");
+
+        // Keyword lookups must not scan the whole index table
+        const QString documentsQuery = QLatin1String(
+                    "SELECT "
+                        "FileNameTable.Title, "
+                        "NamespaceTable.Name, "
+                        "FolderTable.Name, "
+                        "FileNameTable.Name, "
+                        "IndexTable.Anchor ")
+                + joins + QLatin1String(" AND IndexTable.%1 = ?");
+        QString plan = queryPlan(documentsQuery.arg(QLatin1String("Name")));
+        QVERIFY2(plan.contains("IndexTableNameIndex"), qPrintable(plan));
+        plan = queryPlan(documentsQuery.arg(QLatin1String("Identifier")));
+        QVERIFY2(plan.contains("IndexTableIdentifierIndex"), qPrintable(plan));
+
+        // The index view is read in order instead of being sorted afterwards
+        plan = queryPlan(QLatin1String("SELECT DISTINCT IndexTable.Name ") + joins
+                         + QLatin1String(" ORDER BY LOWER(IndexTable.Name), IndexTable.Name"));
+        QVERIFY2(plan.contains("IndexTableLowerNameIndex"), qPrintable(plan));
+        QVERIFY2(!plan.contains("TEMP B-TREE FOR ORDER BY"), qPrintable(plan));
+    }
+}
+
 void tst_QHelpEngineCore::customFilters()
 {
     QHelpEngineCore help(m_colFile, 0);
@@ -8,6 +8,7 @@
 #include <QtCore/qjsondocument.h>
 #include <QtCore/qlibraryinfo.h>
 #include <QtCore/qprocess.h>
+#include <QtCore/qtemporarydir.h>
 
 #include <QtTest/qtest.h>
 
@@ -20,9 +21,13 @@ public:
 private slots:
     void test_data();
     void test();
+    void cache();
 
 private:
     void readExpectedFile(const QString &baseDir, const QString &fileName, QByteArray *content);
+    void runScanner(const QString &dir, const QStringList &extraArguments,
+                    const QString &stdout_file, const QString &stderr_file,
+                    const QString &workingDirectory = QString());
 
     QString m_cmd;
     QString m_basePath;
@@ -82,8 +87,44 @@ void tst_qtattributionsscanner::test()
     if (QFileInfo(dir).isFile())
         dir = QFileInfo(dir).absolutePath();
 
+    runScanner(dir, QStringList(), stdout_file, stderr_file);
+}
+
+void tst_qtattributionsscanner::cache()
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    const QStringList cacheArguments{"--cache", tempDir.filePath("attributions.cache")};
+    const QString dir = QDir(m_basePath).absoluteFilePath("good");
+
+    // The second run takes everything from the cache and must not differ.
+    for (int run = 0; run < 2; ++run) {
+        runScanner(dir, cacheArguments, "good/expected.json", "good/expected.error");
+        if (QTest::currentTestFailed())
+            return;
+        QVERIFY(QFileInfo::exists(cacheArguments.last()));
+    }
+
+    // Scanning the same tree through a relative path hits the cache too,
+    // but the warnings must name the files by the paths of that scan.
+    const QString relativeDir = QStringLiteral("warnings/unknown");
+    const QString expectedJson = relativeDir + QLatin1String("/expected.json");
+    const QString expectedError = relativeDir + QLatin1String("/expected.error");
+    runScanner(QDir(m_basePath).absoluteFilePath(relativeDir), cacheArguments,
+               expectedJson, expectedError);
+    if (QTest::currentTestFailed())
+        return;
+    runScanner(relativeDir, cacheArguments, expectedJson, expectedError, m_basePath);
+}
+
+void tst_qtattributionsscanner::runScanner(const QString &dir, const QStringList &extraArguments,
+                                           const QString &stdout_file, const QString &stderr_file,
+                                           const QString &workingDirectory)
+{
     QProcess proc;
-    const QStringList arguments{dir, "--output-format", "json"};
+    if (!workingDirectory.isEmpty())
+        proc.setWorkingDirectory(workingDirectory);
+    const QStringList arguments = QStringList{dir, "--output-format", "json"} + extraArguments;
     QString command = m_cmd + ' ' + arguments.join(' ');
     QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
     env.insert("QT_ATTRIBUTIONSSCANNER_TEST", "1");
@@ -117,7 +158,9 @@ void tst_qtattributionsscanner::test()
         QVERIFY2(!actualJson.isNull(), "Invalid output: " + jsonError.errorString().toLatin1());
 
         QByteArray expectedOutput;
-        readExpectedFile(dir, stdout_file, &expectedOutput);
+        // Package paths are always absolute
+        readExpectedFile(QDir(workingDirectory).absoluteFilePath(dir), stdout_file,
+                         &expectedOutput);
         QJsonDocument expectedJson = QJsonDocument::fromJson(expectedOutput);
 
         if (!QTest::qCompare(actualJson, expectedJson, "actualJson", "expectedJson", __FILE__, __LINE__)) {
@@ -0,0 +1,87 @@
+// Copyright (C) 2022 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include "qtgradientwidget.h"
+
+#include <QtTest/QtTest>
+
+#include <QtGui/QImage>
+#include <QtGui/QMouseEvent>
+
+QT_USE_NAMESPACE
+
+class tst_QtGradientWidget : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void drag_data();
+    void drag();
+};
+
+void tst_QtGradientWidget::drag_data()
+{
+    QTest::addColumn<QGradient::Type>("type");
+    QTest::addColumn<bool>("checkered");
+
+    QTest::newRow("linear") << QGradient::LinearGradient << false;
+    QTest::newRow("linear, checkered") << QGradient::LinearGradient << true;
+    QTest::newRow("radial") << QGradient::RadialGradient << false;
+    QTest::newRow("radial, checkered") << QGradient::RadialGradient << true;
+    QTest::newRow("conical") << QGradient::ConicalGradient << false;
+    QTest::newRow("conical, checkered") << QGradient::ConicalGradient << true;
+}
+
+static void sendMouseEvent(QWidget *widget, QEvent::Type type, const QPointF &pos,
+                           Qt::MouseButtons buttons)
+{
+    QMouseEvent event(type, pos, widget->mapToGlobal(pos), Qt::LeftButton, buttons,
+                      Qt::NoModifier);
+    QCoreApplication::sendEvent(widget, &event);
+}
+
+// Drags the start handle of a linear gradient or the central handle of a
+// radial or conical one across the widget, and renders a frame for every
+// mouse move like the editor does while a handle is dragged.
+void tst_QtGradientWidget::drag()
+{
+    QFETCH(QGradient::Type, type);
+    QFETCH(bool, checkered);
+
+    const QSize size(600, 400);
+    QtGradientWidget widget;
+    widget.resize(size);
+    widget.setBackgroundCheckered(checkered);
+    widget.setGradientType(type);
+    widget.setGradientStops({ { 0, QColor(255, 0, 0, 64) }, { 0.5, Qt::yellow },
+                              { 1, QColor(0, 0, 255, 192) } });
+    const QPointF start(0.5, 0.5);
+    widget.setStartLinear(start);
+    widget.setEndLinear(QPointF(0.9, 0.9));
+    widget.setCentralRadial(start);
+    widget.setFocalRadial(QPointF(0.8, 0.2));
+    widget.setRadiusRadial(0.4);
+    widget.setCentralConical(start);
+
+    QImage frame(size, QImage::Format_ARGB32_Premultiplied);
+    const int steps = 100;
+    QBENCHMARK {
+        const QPointF pressPos(start.x() * size.width(), start.y() * size.height());
+        sendMouseEvent(&widget, QEvent::MouseButtonPress, pressPos, Qt::LeftButton);
+        for (int i = 1; i <= steps; ++i) {
+            const qreal t = qreal(i) / steps;
+            const QPointF pos(pressPos.x() + t * size.width() / 3,
+                              pressPos.y() - t * size.height() / 3);
+            sendMouseEvent(&widget, QEvent::MouseMove, pos, Qt::LeftButton);
+            widget.render(&frame);
+        }
+        sendMouseEvent(&widget, QEvent::MouseButtonRelease, pressPos, Qt::NoButton);
+        widget.setStartLinear(start);
+        widget.setCentralRadial(start);
+        widget.setCentralConical(start);
+    }
+}
+
+QTEST_MAIN(tst_QtGradientWidget)
+
+#include "tst_bench_qtgradientwidget.moc"
@@ -0,0 +1,70 @@
+// Copyright (C) 2022 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include "translator.h"
+
+#include <QtTest/QtTest>
+
+QT_USE_NAMESPACE
+
+class tst_Translator : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void merge_data();
+    void merge();
+};
+
+void tst_Translator::merge_data()
+{
+    QTest::addColumn<int>("count");
+
+    QTest::newRow("25000") << 25000;
+    QTest::newRow("50000") << 50000;
+    QTest::newRow("100000") << 100000;
+    QTest::newRow("200000") << 200000;
+}
+
+static TranslatorMessage makeMessage(int file, int line)
+{
+    const QString fileName = QStringLiteral("src/file%1.cpp").arg(file);
+    const QString context = QStringLiteral("Context%1").arg(file);
+    return TranslatorMessage(context, QStringLiteral("Text %1 of %2").arg(line).arg(fileName),
+                             QString(), QString(), fileName, line);
+}
+
+// Merges count messages from sources into a translation file that has every
+// other one of them already, like lupdate does after new strings were added
+// all over a project. The time per message should not grow with the count.
+void tst_Translator::merge()
+{
+    QFETCH(int, count);
+
+    const int messagesPerFile = 100;
+    const int files = count / messagesPerFile;
+    Translator existing;
+    QList<TranslatorMessage> extracted;
+    extracted.reserve(count);
+    for (int file = 0; file < files; ++file) {
+        for (int line = 0; line < messagesPerFile; ++line) {
+            const TranslatorMessage msg = makeMessage(file, line);
+            if (line % 2 == 0)
+                existing.append(msg);
+            extracted.append(msg);
+        }
+    }
+
+    QBENCHMARK {
+        Translator tor = existing;
+        for (const TranslatorMessage &msg : extracted) {
+            if (tor.find(msg) < 0)
+                tor.appendSorted(msg);
+        }
+        QCOMPARE(tor.messages().size(), count);
+    }
+}
+
+QTEST_MAIN(tst_Translator)
+
+#include "tst_bench_translator.moc"